@@ -0,0 +1,318 @@
+/**
+ * @file benchmark_session.ino
+ * @brief Libtropic Secure Channel Session establishment benchmark using the C++ wrapper.
+ * @copyright Copyright (c) 2020-2025 Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+/***************************************************************************
+ *
+ * Secure Channel Session Benchmark TROPIC01 Example
+ *
+ * This example demonstrates how to:
+ * 1. Measure the latency of Secure Channel Session establishment
+ *    (secureSessionStart()) and termination (secureSessionEnd()).
+ * 2. Compare the cost of chip verification, precomputed ephemeral keys
+ *    (prepareSession()) and a calibrated SPI clock (calibrateSpiClock()).
+ *
+ * The benchmark runs BENCH_ROUNDS rounds and prints the results as CSV,
+ * so they can be collected from several boards and compared. Every line
+ * starts with its record type:
+ *   config,<board>,<spi_hz>,<verify>,<prepare>,<calibrate>,<rounds>
+ *   round,<index>,<ret>,<chip_id_us>,<cert_store_us>,<st_pub_parse_us>,
+ *         <eph_keys_us>,<handshake_us>,<host_keys_us>,<start_us>,<end_us>
+ *   summary,<metric>,<ok>,<failed>,<min_us>,<p50_us>,<p90_us>,<p99_us>,<max_us>
+ *   rate,<sessions_per_s>
+ * Lines starting with '#' are comments.
+ *
+ * For more information, refer to:
+ * 1. Tropic Square: https://tropicsquare.com/
+ * 2. TROPIC01: https://tropicsquare.com/tropic01
+ * 3. Libtropic: https://tropicsquare.github.io/libtropic
+ *
+ ***************************************************************************/
+
+// Arduino libraries.
+#include <Arduino.h>
+#include <SPI.h>
+// LibtropicArduino library.
+#include <LibtropicArduino.h>
+// MbedTLS's PSA Crypto library.
+#include "psa/crypto.h"
+
+// -------------------------------------- TROPIC01 related macros --------------------------------------
+// GPIO pin definitions.
+#define TROPIC01_CS_PIN 5  // Platform's pin number where TROPIC01's SPI Chip Select pin is connected.
+#if LT_USE_INT_PIN
+#define TROPIC01_INT_PIN \
+    4  // Platform's pin number where TROPIC01's interrupt pin is connected.
+       // Is necessary only when -DLT_USE_INT_PIN=1 was set in build_flags.
+#endif
+
+// Pairing Key macros for establishing a Secure Channel Session with TROPIC01.
+// Using the default Pairing Key slot 0 of Production TROPIC01 chips.
+#define PAIRING_KEY_PRIV sh0priv_prod0
+#define PAIRING_KEY_PUB sh0pub_prod0
+#define PAIRING_KEY_SLOT TR01_PAIRING_KEY_SLOT_INDEX_0
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Benchmark options ----------------------------------------
+// SPI clock applied with setSpiClock() before begin() and reported in the "config" line.
+#define BENCH_SPI_CLOCK_HZ 10000000
+// Number of measured rounds.
+#define BENCH_ROUNDS 100
+// 1: Verify the chip (read the certificate store) in every round, 0: verify only in the first round.
+#define BENCH_VERIFY_CHIP 0
+// 1: Prepare the host ephemeral key pair with prepareSession() before every (measured) round.
+#define BENCH_PREPARE_SESSION 0
+// 1: Calibrate the SPI clock with calibrateSpiClock() before the benchmark.
+#define BENCH_CALIBRATE_SPI 0
+// 1: Print a "round" line for every round, 0: print only the summary.
+#define BENCH_PRINT_ROUNDS 1
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------ TROPIC01 related variables -------------------------------------
+#if LT_SEPARATE_L3_BUFF
+// User's own buffer for L3 Layer data.
+uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16))) = {0};
+#endif
+
+Tropic01 tropic01(TROPIC01_CS_PIN
+#if LT_USE_INT_PIN
+                  ,
+                  TROPIC01_INT_PIN
+#endif
+#if LT_SEPARATE_L3_BUFF
+                  ,
+                  l3_buffer, sizeof(l3_buffer)
+#endif
+);  // TROPIC01 instance.
+
+lt_ret_t returnVal;  // Used for return values of Tropic01's methods.
+
+// Measured latencies of successful rounds.
+uint32_t startUs[BENCH_ROUNDS];
+uint32_t endUs[BENCH_ROUNDS];
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Other variables ------------------------------------------
+// Used when initializing MbedTLS's PSA Crypto.
+psa_status_t psaStatus;
+// -----------------------------------------------------------------------------------------------------
+
+// ---------------------------------------- Static local functions ------------------------------------------
+// Helper function to save some source code lines when printing Libtropic errors using Serial.
+static void printLibtropicError(const char prefixMsg[], const lt_ret_t ret)
+{
+    Serial.print(prefixMsg);
+    Serial.print(ret);
+    Serial.print(" (");
+    Serial.print(lt_ret_verbose(ret));
+    Serial.println(")");
+}
+
+static void cleanResourcesAndLoopForever(void)
+{
+    tropic01.end();             // Aborts all communication with TROPIC01 and frees resources.
+    mbedtls_psa_crypto_free();  // Frees MbedTLS's PSA Crypto resources.
+    SPI.end();                  // Deinitialize SPI.
+
+    while (true);
+}
+
+// Sorts the samples in ascending order (insertion sort is enough for the number of rounds).
+static void sortSamples(uint32_t samples[], const uint16_t count)
+{
+    for (uint16_t i = 1; i < count; i++) {
+        const uint32_t sample = samples[i];
+        uint16_t j = i;
+        while (j > 0 && samples[j - 1] > sample) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = sample;
+    }
+}
+
+// Returns the nearest-rank percentile of sorted samples.
+static uint32_t percentile(const uint32_t sorted[], const uint16_t count, const uint8_t pct)
+{
+    uint32_t rank = ((uint32_t)pct * count + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static void printSummary(const char metric[], uint32_t samples[], const uint16_t ok, const uint16_t failed)
+{
+    Serial.print("summary,");
+    Serial.print(metric);
+    Serial.print(",");
+    Serial.print((unsigned long)ok);
+    Serial.print(",");
+    Serial.print((unsigned long)failed);
+    if (!ok) {
+        Serial.println(",,,,,");
+        return;
+    }
+
+    sortSamples(samples, ok);
+    Serial.print(",");
+    Serial.print((unsigned long)samples[0]);
+    Serial.print(",");
+    Serial.print((unsigned long)percentile(samples, ok, 50));
+    Serial.print(",");
+    Serial.print((unsigned long)percentile(samples, ok, 90));
+    Serial.print(",");
+    Serial.print((unsigned long)percentile(samples, ok, 99));
+    Serial.print(",");
+    Serial.println((unsigned long)samples[ok - 1]);
+}
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Setup function -------------------------------------------
+void setup()
+{
+    // Initialize SPI (using the default SPI instance defined in <SPI.h>).
+    // If you want to use non-default SPI instance, don't forget to pass it to the
+    // Tropic01() constructor (otherwise it will use the default SPI instance).
+    SPI.begin();
+
+    Serial.begin(115200);
+    while (!Serial);  // Wait for serial port to connect.
+
+    Serial.println("# ===============================================================");
+    Serial.println("# ========= TROPIC01 Secure Channel Session Benchmark ===========");
+    Serial.println("# ===============================================================");
+
+    // Init MbedTLS's PSA Crypto.
+    psaStatus = psa_crypto_init();
+    if (psaStatus != PSA_SUCCESS) {
+        Serial.print("# MbedTLS's PSA Crypto initialization failed, psa_status_t=");
+        Serial.println(psaStatus);
+        cleanResourcesAndLoopForever();
+    }
+
+    // Init Tropic01 resources.
+    tropic01.setSpiClock(BENCH_SPI_CLOCK_HZ);
+    returnVal = tropic01.begin();
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.begin() failed, returnVal=", returnVal);
+        cleanResourcesAndLoopForever();
+    }
+
+#if BENCH_CALIBRATE_SPI
+    uint32_t clockHz;
+    returnVal = tropic01.calibrateSpiClock(clockHz);
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.calibrateSpiClock() failed, returnVal=", returnVal);
+        cleanResourcesAndLoopForever();
+    }
+#endif
+
+    // Warm-up round, so the first measured round does not include one-time initialization.
+    returnVal = tropic01.secureSessionStart(PAIRING_KEY_PRIV, PAIRING_KEY_PUB, PAIRING_KEY_SLOT);
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.secureSessionStart() failed, returnVal=", returnVal);
+        cleanResourcesAndLoopForever();
+    }
+    tropic01.secureSessionEnd();
+
+    Serial.println("# config,board,spi_hz,verify,prepare,calibrate,rounds");
+    Serial.print("config,");
+#ifdef ARDUINO_BOARD
+    Serial.print(ARDUINO_BOARD);
+#else
+    Serial.print("unknown");
+#endif
+    Serial.print(",");
+    Serial.print((unsigned long)tropic01.getSpiClock());
+    Serial.print(",");
+    Serial.print(BENCH_VERIFY_CHIP);
+    Serial.print(",");
+    Serial.print(BENCH_PREPARE_SESSION);
+    Serial.print(",");
+    Serial.print(BENCH_CALIBRATE_SPI);
+    Serial.print(",");
+    Serial.println(BENCH_ROUNDS);
+
+#if BENCH_PRINT_ROUNDS
+    Serial.println(
+        "# round,index,ret,chip_id_us,cert_store_us,st_pub_parse_us,eph_keys_us,handshake_us,host_keys_us,start_us,"
+        "end_us");
+#endif
+}
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Loop function --------------------------------------------
+void loop()
+{
+    uint16_t ok = 0, failed = 0;
+    uint64_t totalUs = 0;
+    Tropic01::HandshakeTiming timing;
+
+    for (uint16_t round = 0; round < BENCH_ROUNDS; round++) {
+#if BENCH_VERIFY_CHIP
+        tropic01.clearChipIdentity();
+#endif
+#if BENCH_PREPARE_SESSION
+        returnVal = tropic01.prepareSession();
+        if (returnVal != LT_OK) {
+            printLibtropicError("# Tropic01.prepareSession() failed, returnVal=", returnVal);
+            cleanResourcesAndLoopForever();
+        }
+#endif
+
+        memset(&timing, 0, sizeof(timing));
+        returnVal = tropic01.secureSessionStart(PAIRING_KEY_PRIV, PAIRING_KEY_PUB, PAIRING_KEY_SLOT, &timing);
+        uint32_t roundEndUs = 0;
+        if (returnVal == LT_OK) {
+            uint32_t t0 = micros();
+            returnVal = tropic01.secureSessionEnd();
+            roundEndUs = micros() - t0;
+        }
+
+#if BENCH_PRINT_ROUNDS
+        Serial.print("round,");
+        Serial.print((unsigned long)round);
+        Serial.print(",");
+        Serial.print(returnVal);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.chipIdUs);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.certStoreUs);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.stPubParseUs);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.ephKeysUs);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.handshakeUs);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.hostKeysUs);
+        Serial.print(",");
+        Serial.print((unsigned long)timing.totalUs);
+        Serial.print(",");
+        Serial.println((unsigned long)roundEndUs);
+#endif
+
+        if (returnVal != LT_OK) {
+            failed++;
+            continue;
+        }
+        startUs[ok] = timing.totalUs;
+        endUs[ok] = roundEndUs;
+        totalUs += timing.totalUs + roundEndUs;
+        ok++;
+    }
+
+    Serial.println("# summary,metric,ok,failed,min_us,p50_us,p90_us,p99_us,max_us");
+    printSummary("start", startUs, ok, failed);
+    printSummary("end", endUs, ok, failed);
+
+    Serial.println("# rate,sessions_per_s");
+    Serial.print("rate,");
+    Serial.println(totalUs ? (double)ok * 1000000.0 / (double)totalUs : 0.0);
+
+    Serial.println("# done");
+    cleanResourcesAndLoopForever();
+}
+// -----------------------------------------------------------------------------------------------------
@@ -0,0 +1,258 @@
+/**
+ * @file benchmark_sign_batch.ino
+ * @brief Libtropic batched ECDSA signing benchmark using the C++ wrapper.
+ * @copyright Copyright (c) 2020-2025 Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+/***************************************************************************
+ *
+ * Batched ECDSA Signing Benchmark TROPIC01 Example
+ *
+ * This example demonstrates how to:
+ * 1. Sign many small records with ecdsaSignBatch(), which computes SHA-256
+ *    of the next record while TROPIC01 signs the current one.
+ * 2. Compare its throughput with a loop of single ecdsaSign() calls.
+ *
+ * The benchmark generates a P-256 key in BENCH_SLOT, signs BENCH_MSGS
+ * records of BENCH_MSG_LEN bytes BENCH_ROUNDS times with both methods
+ * and erases the key. The results are printed as CSV, every line starts
+ * with its record type:
+ *   config,<board>,<spi_hz>,<msgs>,<msg_len>,<rounds>
+ *   result,<method>,<signatures>,<failed>,<elapsed_us>,<sigs_per_s>
+ * Lines starting with '#' are comments.
+ *
+ * For more information, refer to:
+ * 1. Tropic Square: https://tropicsquare.com/
+ * 2. TROPIC01: https://tropicsquare.com/tropic01
+ * 3. Libtropic: https://tropicsquare.github.io/libtropic
+ *
+ ***************************************************************************/
+
+// Arduino libraries.
+#include <Arduino.h>
+#include <SPI.h>
+// LibtropicArduino library.
+#include <LibtropicArduino.h>
+// MbedTLS's PSA Crypto library.
+#include "psa/crypto.h"
+
+// -------------------------------------- TROPIC01 related macros --------------------------------------
+// GPIO pin definitions.
+#define TROPIC01_CS_PIN 5  // Platform's pin number where TROPIC01's SPI Chip Select pin is connected.
+#if LT_USE_INT_PIN
+#define TROPIC01_INT_PIN \
+    4  // Platform's pin number where TROPIC01's interrupt pin is connected.
+       // Is necessary only when -DLT_USE_INT_PIN=1 was set in build_flags.
+#endif
+
+// Pairing Key macros for establishing a Secure Channel Session with TROPIC01.
+// Using the default Pairing Key slot 0 of Production TROPIC01 chips.
+#define PAIRING_KEY_PRIV sh0priv_prod0
+#define PAIRING_KEY_PUB sh0pub_prod0
+#define PAIRING_KEY_SLOT TR01_PAIRING_KEY_SLOT_INDEX_0
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Benchmark options ----------------------------------------
+// SPI clock applied with setSpiClock() before begin() and reported in the "config" line.
+#define BENCH_SPI_CLOCK_HZ 10000000
+// ECC key slot used for the benchmark, its key is generated at the start and erased at the end.
+#define BENCH_SLOT TR01_ECC_SLOT_1
+// Number of records signed by one ecdsaSignBatch() call.
+#define BENCH_MSGS 16
+// Length of one record.
+#define BENCH_MSG_LEN 64
+// Number of measured rounds of each method.
+#define BENCH_ROUNDS 10
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------ TROPIC01 related variables -------------------------------------
+#if LT_SEPARATE_L3_BUFF
+// User's own buffer for L3 Layer data.
+uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16))) = {0};
+#endif
+
+Tropic01 tropic01(TROPIC01_CS_PIN
+#if LT_USE_INT_PIN
+                  ,
+                  TROPIC01_INT_PIN
+#endif
+#if LT_SEPARATE_L3_BUFF
+                  ,
+                  l3_buffer, sizeof(l3_buffer)
+#endif
+);  // TROPIC01 instance.
+
+lt_ret_t returnVal;  // Used for return values of Tropic01's methods.
+
+// Records to sign and their signatures.
+uint8_t records[BENCH_MSGS][BENCH_MSG_LEN];
+uint8_t signatures[BENCH_MSGS][TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+const uint8_t *recordPtrs[BENCH_MSGS];
+uint32_t recordLens[BENCH_MSGS];
+uint8_t *signaturePtrs[BENCH_MSGS];
+lt_ret_t signatureRets[BENCH_MSGS];
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Other variables ------------------------------------------
+// Used when initializing MbedTLS's PSA Crypto.
+psa_status_t psaStatus;
+// -----------------------------------------------------------------------------------------------------
+
+// ---------------------------------------- Static local functions ------------------------------------------
+// Helper function to save some source code lines when printing Libtropic errors using Serial.
+static void printLibtropicError(const char prefixMsg[], const lt_ret_t ret)
+{
+    Serial.print(prefixMsg);
+    Serial.print(ret);
+    Serial.print(" (");
+    Serial.print(lt_ret_verbose(ret));
+    Serial.println(")");
+}
+
+static void cleanResourcesAndLoopForever(void)
+{
+    tropic01.end();             // Aborts all communication with TROPIC01 and frees resources.
+    mbedtls_psa_crypto_free();  // Frees MbedTLS's PSA Crypto resources.
+    SPI.end();                  // Deinitialize SPI.
+
+    while (true);
+}
+
+static void printResult(const char method[], const uint32_t signatures, const uint32_t failed,
+                        const uint32_t elapsedUs)
+{
+    Serial.print("result,");
+    Serial.print(method);
+    Serial.print(",");
+    Serial.print((unsigned long)signatures);
+    Serial.print(",");
+    Serial.print((unsigned long)failed);
+    Serial.print(",");
+    Serial.print((unsigned long)elapsedUs);
+    Serial.print(",");
+    Serial.println(elapsedUs ? (double)signatures * 1000000.0 / (double)elapsedUs : 0.0);
+}
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Setup function -------------------------------------------
+void setup()
+{
+    // Initialize SPI (using the default SPI instance defined in <SPI.h>).
+    // If you want to use non-default SPI instance, don't forget to pass it to the
+    // Tropic01() constructor (otherwise it will use the default SPI instance).
+    SPI.begin();
+
+    Serial.begin(115200);
+    while (!Serial);  // Wait for serial port to connect.
+
+    Serial.println("# ===============================================================");
+    Serial.println("# =========== TROPIC01 Batched ECDSA Signing Benchmark ==========");
+    Serial.println("# ===============================================================");
+
+    // Init MbedTLS's PSA Crypto.
+    psaStatus = psa_crypto_init();
+    if (psaStatus != PSA_SUCCESS) {
+        Serial.print("# MbedTLS's PSA Crypto initialization failed, psa_status_t=");
+        Serial.println(psaStatus);
+        cleanResourcesAndLoopForever();
+    }
+
+    // Init Tropic01 resources.
+    tropic01.setSpiClock(BENCH_SPI_CLOCK_HZ);
+    returnVal = tropic01.begin();
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.begin() failed, returnVal=", returnVal);
+        cleanResourcesAndLoopForever();
+    }
+
+    returnVal = tropic01.secureSessionStart(PAIRING_KEY_PRIV, PAIRING_KEY_PUB, PAIRING_KEY_SLOT);
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.secureSessionStart() failed, returnVal=", returnVal);
+        cleanResourcesAndLoopForever();
+    }
+
+    returnVal = tropic01.eccKeyGenerate(BENCH_SLOT, TR01_CURVE_P256);
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.eccKeyGenerate() failed, returnVal=", returnVal);
+        cleanResourcesAndLoopForever();
+    }
+
+    // Records differ in their content, so every signature is computed from a different digest.
+    for (uint16_t i = 0; i < BENCH_MSGS; i++) {
+        for (uint16_t j = 0; j < BENCH_MSG_LEN; j++) {
+            records[i][j] = (uint8_t)(i * 31 + j);
+        }
+        recordPtrs[i] = records[i];
+        recordLens[i] = BENCH_MSG_LEN;
+        signaturePtrs[i] = signatures[i];
+    }
+
+    Serial.println("# config,board,spi_hz,msgs,msg_len,rounds");
+    Serial.print("config,");
+#ifdef ARDUINO_BOARD
+    Serial.print(ARDUINO_BOARD);
+#else
+    Serial.print("unknown");
+#endif
+    Serial.print(",");
+    Serial.print((unsigned long)tropic01.getSpiClock());
+    Serial.print(",");
+    Serial.print(BENCH_MSGS);
+    Serial.print(",");
+    Serial.print(BENCH_MSG_LEN);
+    Serial.print(",");
+    Serial.println(BENCH_ROUNDS);
+}
+// -----------------------------------------------------------------------------------------------------
+
+// ------------------------------------------ Loop function --------------------------------------------
+void loop()
+{
+    uint32_t signedCount = 0, failed = 0, elapsedUs = 0;
+
+    Serial.println("# result,method,signatures,failed,elapsed_us,sigs_per_s");
+
+    // Baseline: one ecdsaSign() call per record.
+    for (uint16_t round = 0; round < BENCH_ROUNDS; round++) {
+        const uint32_t startUs = micros();
+        for (uint16_t i = 0; i < BENCH_MSGS; i++) {
+            if (tropic01.ecdsaSign(BENCH_SLOT, records[i], BENCH_MSG_LEN, signatures[i]) == LT_OK) {
+                signedCount++;
+            }
+            else {
+                failed++;
+            }
+        }
+        elapsedUs += micros() - startUs;
+    }
+    printResult("ecdsaSign", signedCount, failed, elapsedUs);
+
+    // All records of a round in one ecdsaSignBatch() call.
+    signedCount = failed = elapsedUs = 0;
+    for (uint16_t round = 0; round < BENCH_ROUNDS; round++) {
+        const uint32_t startUs = micros();
+        tropic01.ecdsaSignBatch(BENCH_SLOT, recordPtrs, recordLens, BENCH_MSGS, signaturePtrs, signatureRets);
+        elapsedUs += micros() - startUs;
+
+        for (uint16_t i = 0; i < BENCH_MSGS; i++) {
+            if (signatureRets[i] == LT_OK) {
+                signedCount++;
+            }
+            else {
+                failed++;
+            }
+        }
+    }
+    printResult("ecdsaSignBatch", signedCount, failed, elapsedUs);
+
+    returnVal = tropic01.eccKeyErase(BENCH_SLOT);
+    if (returnVal != LT_OK) {
+        printLibtropicError("# Tropic01.eccKeyErase() failed, returnVal=", returnVal);
+    }
+
+    Serial.println("# done");
+    cleanResourcesAndLoopForever();
+}
+// -----------------------------------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+import argparse
+import pathlib
+import struct
+
+# Binary format written by Tropic01::traceDump()
+MAGIC = b"LTTR"
+HEADER = struct.Struct("<4sBBH")
+ENTRY = struct.Struct("<IHBB")
+VERSION = 1
+
+KINDS = {
+    0: "CMD_START",
+    1: "CMD_END",
+    2: "L3_TX",
+    3: "L3_RX",
+}
+
+COMMAND_TYPES = {
+    0: "FAST",
+    1: "KEYGEN",
+    2: "SIGN",
+    3: "R_MEM",
+    4: "SESSION",
+}
+
+L3_CMD_IDS = {
+    0x01: "PING",
+    0x40: "R_MEM_DATA_WRITE",
+    0x41: "R_MEM_DATA_READ",
+    0x70: "ECDSA_SIGN",
+    0x71: "EDDSA_SIGN",
+    0x90: "MAC_AND_DESTROY",
+}
+
+def describe_status(kind: int, status: int) -> str:
+    if kind == 0:
+        return COMMAND_TYPES.get(status, f"type {status}")
+    if kind == 2:
+        return L3_CMD_IDS.get(status, f"cmd 0x{status:02x}")
+    return f"lt_ret_t {status}"
+
+def decode(data: bytes):
+    if len(data) < HEADER.size:
+        raise ValueError("Dump is shorter than its header.")
+
+    magic, version, entry_len, count = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError(f"Wrong magic {magic!r}, expected {MAGIC!r}.")
+    if version != VERSION or entry_len != ENTRY.size:
+        raise ValueError(f"Unsupported dump version {version} with record size {entry_len}.")
+    if len(data) < HEADER.size + count * ENTRY.size:
+        raise ValueError(f"Dump is truncated, expected {count} records.")
+
+    return [ENTRY.unpack_from(data, HEADER.size + i * ENTRY.size) for i in range(count)]
+
+if __name__ == "__main__":
+    # Register argument parser, argument and parse
+    parser = argparse.ArgumentParser(
+        description = "Decodes a binary trace dump from Tropic01::traceDump() into a timeline."
+    )
+
+    parser.add_argument(
+        "dump",
+        help     = "Path to the file with the binary dump.",
+        type     = pathlib.Path
+    )
+
+    args = parser.parse_args()
+
+    entries = decode(args.dump.read_bytes())
+    if not entries:
+        print("Trace is empty.")
+        raise SystemExit(0)
+
+    # micros() wraps around after ~71 minutes, hence the modulo
+    start_us = entries[0][0]
+    prev_us = start_us
+    print(f"{'#':>5} {'time [us]':>12} {'delta [us]':>11}  {'kind':<9} {'len':>5}  status")
+    for index, (timestamp_us, length, kind, status) in enumerate(entries):
+        time_us = (timestamp_us - start_us) % (1 << 32)
+        delta_us = (timestamp_us - prev_us) % (1 << 32)
+        prev_us = timestamp_us
+        print(f"{index:>5} {time_us:>12} {delta_us:>11}  {KINDS.get(kind, str(kind)):<9} {length:>5}  "
+              f"{describe_status(kind, status)}")
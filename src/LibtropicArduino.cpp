@@ -8,6 +8,233 @@
 
 #include "LibtropicArduino.h"
 
+#include <stddef.h>
+
+#include "libtropic_l3.h"
+#include "lt_l2.h"
+#include "lt_l2_api_structs.h"
+#include "lt_l3_api_structs.h"
+#include "lt_l3_process.h"
+#include "mbedtls/platform_util.h"
+#include "psa/crypto.h"
+
+// L3 frame layout as defined in the TROPIC01 datasheet:
+// command:  CMD_SIZE (2B, little endian) | CMD_ID (1B) | payload | TAG (16B)
+// response: RES_SIZE (2B, little endian) | RESULT (1B) | payload | TAG (16B)
+#define L3_SIZE_LEN 2
+#define L3_ID_LEN 1
+#define L3_TAG_LEN 16
+#define L3_PAYLOAD_OFFSET (L3_SIZE_LEN + L3_ID_LEN)
+
+// Ping payloads: DATA_IN (command), DATA_OUT (response).
+#define PING_LEN_MAX 4096
+
+// R_Mem_Data_Write, R_Mem_Data_Read and MAC_And_Destroy payloads:
+// command:  UDATA_SLOT / SLOT (2B, little endian) | PADDING (1B) | DATA (write, MAC-and-Destroy)
+// response: PADDING (3B) | DATA (read, MAC-and-Destroy)
+#define SLOT_CMD_DATA_OFFSET 3
+#define SLOT_RES_DATA_OFFSET 3
+#define R_MEM_DATA_LEN_MAX 475
+#define MAC_AND_DESTROY_DATA_LEN 32
+
+// ECDSA_Sign and EdDSA_Sign frames are built through Libtropic's L3 command and response structs.
+#define EDDSA_MSG_LEN_MAX sizeof(lt_l3_eddsa_sign_cmd_t::msg)
+#define EDDSA_CMD_MSG_OFFSET (offsetof(struct lt_l3_eddsa_sign_cmd_t, msg) - L3_PAYLOAD_OFFSET)
+#define SHA256_DIGEST_LEN sizeof(lt_l3_ecdsa_sign_cmd_t::msg_hash)
+
+// Binary trace dump format, see Tropic01::traceDump().
+#define TRACE_DUMP_MAGIC "LTTR"
+#define TRACE_DUMP_VERSION 1
+#define TRACE_DUMP_ENTRY_LEN 8
+
+const Tropic01::BusyRetryPolicy Tropic01::DEFAULT_BUSY_RETRY_POLICY = {
+    3,    // maxRetries
+    2,    // backoffFactor
+    100,  // maxDelayMs
+    10,   // initialDelayMs
+};
+
+template <typename F>
+lt_ret_t Tropic01::runCommand(const CommandType type, F command)
+{
+    this->traceRecord(TRACE_KIND_CMD_START, 0, type);
+    lt_ret_t ret = command();
+    this->traceRecord(TRACE_KIND_CMD_END, 0, ret);
+
+    return ret;
+}
+
+template <typename F>
+lt_ret_t Tropic01::pollResponse(F receive)
+{
+    // LT_L1_CHIP_BUSY means the request was already delivered, so only the response is polled again. Sending the
+    // request again could execute the command twice.
+    lt_ret_t ret = receive();
+
+    uint32_t delayMs = this->busyRetryPolicy.initialDelayMs;
+    for (uint8_t retry = 0; ret == LT_L1_CHIP_BUSY && retry < this->busyRetryPolicy.maxRetries; retry++) {
+        delay(delayMs);
+        ret = receive();
+
+        delayMs *= this->busyRetryPolicy.backoffFactor;
+        if (delayMs > this->busyRetryPolicy.maxDelayMs) {
+            delayMs = this->busyRetryPolicy.maxDelayMs;
+        }
+    }
+
+    return ret;
+}
+
+static uint32_t elapsedUs(const uint32_t startUs) { return (uint32_t)(micros() - startUs); }
+
+// Folds one sample into a running minimum, average and maximum.
+static void updateStat(uint32_t &minUs, uint32_t &avgUs, uint32_t &maxUs, uint64_t &sumUs, const uint32_t us,
+                       const uint32_t count)
+{
+    if (count == 1 || us < minUs) {
+        minUs = us;
+    }
+    if (count == 1 || us > maxUs) {
+        maxUs = us;
+    }
+    // The average is taken from the exact sum, an incremental update would stop moving once count is large.
+    sumUs += us;
+    avgUs = (uint32_t)(sumUs / count);
+}
+
+// Generates host ephemeral X25519 key pair for the Secure Channel Session handshake.
+static lt_ret_t generateEphKeys(lt_host_eph_keys_t &keys)
+{
+    psa_key_attributes_t attributes = PSA_KEY_ATTRIBUTES_INIT;
+    psa_key_id_t keyId = 0;
+    size_t len;
+
+    psa_set_key_usage_flags(&attributes, PSA_KEY_USAGE_EXPORT);
+    psa_set_key_algorithm(&attributes, PSA_ALG_ECDH);
+    psa_set_key_type(&attributes, PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_MONTGOMERY));
+    psa_set_key_bits(&attributes, 255);
+
+    psa_status_t status = psa_generate_key(&attributes, &keyId);
+    psa_reset_key_attributes(&attributes);
+    if (status != PSA_SUCCESS) {
+        return LT_CRYPTO_ERR;
+    }
+
+    status = psa_export_key(keyId, keys.ehpriv, sizeof(keys.ehpriv), &len);
+    if (status == PSA_SUCCESS) {
+        status = psa_export_public_key(keyId, keys.ehpub, sizeof(keys.ehpub), &len);
+    }
+    psa_destroy_key(keyId);
+
+    if (status != PSA_SUCCESS) {
+        mbedtls_platform_zeroize(&keys, sizeof(keys));
+        return LT_CRYPTO_ERR;
+    }
+
+    return LT_OK;
+}
+
+// Computes SHA-256 digest of the message, which is signed by TROPIC01's ECDSA_Sign command.
+static lt_ret_t hashMessage(const uint8_t msg[], const uint32_t msgLen, uint8_t digest[])
+{
+    size_t hashLen;
+    if (psa_hash_compute(PSA_ALG_SHA_256, msg, msgLen, digest, SHA256_DIGEST_LEN, &hashLen) != PSA_SUCCESS) {
+        return LT_CRYPTO_ERR;
+    }
+
+    return LT_OK;
+}
+
+// Where the raw R and S bytes are written, so the DER encoding can be done in place (it never gets ahead of them).
+static uint8_t *rawSignature(uint8_t sig[], const Tropic01::SignatureFormat format)
+{
+    return &sig[Tropic01::signatureMaxLen(format) - TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+}
+
+// Length of a 32-byte big-endian unsigned integer encoded as DER INTEGER content.
+static uint8_t derIntegerLen(const uint8_t value[], uint8_t &skip)
+{
+    for (skip = 0; skip < TR01_ECDSA_EDDSA_SIGNATURE_LENGTH / 2 - 1 && value[skip] == 0; skip++);
+    const uint8_t len = TR01_ECDSA_EDDSA_SIGNATURE_LENGTH / 2 - skip;
+    // A leading 0x00 keeps the integer positive.
+    return (value[skip] & 0x80) ? len + 1 : len;
+}
+
+// Writes DER INTEGER from a source which might overlap with the destination (but is not before it).
+static uint8_t *derWriteInteger(uint8_t *out, const uint8_t value[], const uint8_t skip, const uint8_t len)
+{
+    const uint8_t valueLen = TR01_ECDSA_EDDSA_SIGNATURE_LENGTH / 2 - skip;
+    *out++ = 0x02;
+    *out++ = len;
+    if (len > valueLen) {
+        *out++ = 0x00;
+    }
+    memmove(out, &value[skip], valueLen);
+    return out + valueLen;
+}
+
+// Converts the signature written at rawSignature() into the requested format.
+static void formatSignature(uint8_t sig[], uint8_t &sigLen, const Tropic01::SignatureFormat format)
+{
+    if (format != Tropic01::SIGNATURE_FORMAT_DER) {
+        sigLen = TR01_ECDSA_EDDSA_SIGNATURE_LENGTH;
+        return;
+    }
+
+    // Ecdsa-Sig-Value ::= SEQUENCE { r INTEGER, s INTEGER }
+    const uint8_t *r = rawSignature(sig, format);
+    const uint8_t *s = &r[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH / 2];
+    uint8_t rSkip, sSkip;
+    const uint8_t rLen = derIntegerLen(r, rSkip);
+    const uint8_t sLen = derIntegerLen(s, sSkip);
+
+    uint8_t *out = sig;
+    *out++ = 0x30;
+    *out++ = 2 + rLen + 2 + sLen;
+    out = derWriteInteger(out, r, rSkip, rLen);
+    out = derWriteInteger(out, s, sSkip, sLen);
+    sigLen = out - sig;
+}
+
+// Views of the L3 buffer as ECDSA_Sign and EdDSA_Sign commands.
+static struct lt_l3_ecdsa_sign_cmd_t *ecdsaSignCmd(uint8_t l3Buff[]) { return (struct lt_l3_ecdsa_sign_cmd_t *)l3Buff; }
+
+static struct lt_l3_eddsa_sign_cmd_t *eddsaSignCmd(uint8_t l3Buff[]) { return (struct lt_l3_eddsa_sign_cmd_t *)l3Buff; }
+
+// Return values meaning that the Secure Channel Session is no longer valid.
+static bool isSessionLost(const lt_ret_t ret)
+{
+    return ret == LT_HOST_NO_SESSION || ret == LT_L2_NO_SESSION || ret == LT_L2_TAG_ERR;
+}
+
+template <typename F>
+lt_ret_t Tropic01::runSessionCommand(const CommandType type, F command)
+{
+    lt_ret_t ret = this->reopenIdleSession();
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = this->runCommand(type, command);
+    this->sessionLastActivityMs = millis();
+    if (!this->autoRecovery || !this->sessionShiPriv || !isSessionLost(ret)) {
+        return ret;
+    }
+
+    const uint32_t startUs = micros();
+    const lt_ret_t recoveryRet
+        = this->secureSessionStart(this->sessionShiPriv, this->sessionShiPub, this->sessionPkeyIndex);
+    this->recoveryStats.recoveryTimeUs += (uint32_t)(micros() - startUs);
+
+    if (recoveryRet != LT_OK) {
+        this->recoveryStats.failedRecoveries++;
+        return ret;
+    }
+    this->recoveryStats.recoveries++;
+
+    return this->runCommand(type, command);
+}
+
 Tropic01::Tropic01(const uint16_t spiCSPin
 #if LT_USE_INT_PIN
                    ,
@@ -39,6 +266,19 @@ Tropic01::Tropic01(const uint16_t spiCSPin
 #endif
 
     this->initialized = false;
+    this->spiClockHz = 0;
+    this->busyRetryPolicy = DEFAULT_BUSY_RETRY_POLICY;
+    this->traceDisable();
+    this->chipIdentityValid = false;
+    this->autoRecovery = false;
+    this->resetRecoveryStats();
+    this->sessionIdleTimeoutMs = 0;
+    this->sessionLastActivityMs = 0;
+    this->forgetSessionKeys();
+    memset(this->identities, 0, sizeof(this->identities));
+    this->ephKeysCount = 0;
+    this->resetHandshakeStats();
+    this->signHashActive = false;
 }
 
 lt_ret_t Tropic01::begin(void)
@@ -61,6 +301,12 @@ lt_ret_t Tropic01::end(void)
         return LT_OK;
     }
     this->initialized = false;
+    this->forgetSessionKeys();
+    this->wipeEphKeysPool();
+    if (this->signHashActive) {
+        psa_hash_abort(&this->signHashOp);
+        this->signHashActive = false;
+    }
 
     lt_ret_t ret_abort = LT_OK, ret_deinit = LT_OK;
 
@@ -77,60 +323,1190 @@ lt_ret_t Tropic01::end(void)
     return ret_deinit;
 }
 
-lt_ret_t Tropic01::secureSessionStart(const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex)
+void Tropic01::setSpiClock(const uint32_t clockHz)
 {
-    return lt_verify_chip_and_start_secure_session(&this->handle, shiPriv, shiPub, pkeyIndex);
+    this->device.spi_settings = SPISettings(clockHz, MSBFIRST, SPI_MODE0);
+    this->spiClockHz = clockHz;
 }
 
-lt_ret_t Tropic01::secureSessionEnd(void) { return lt_session_abort(&this->handle); }
+uint32_t Tropic01::getSpiClock(void) const { return this->spiClockHz; }
+
+lt_ret_t Tropic01::calibrateSpiClock(uint32_t &clockHz, const uint32_t minClockHz, const uint32_t maxClockHz,
+                                     const uint32_t stepHz, const uint8_t marginSteps, const uint16_t rounds)
+{
+    // The session would not survive a failed frame at an unstable clock.
+    if (!this->initialized || this->handle.l3.session_status == LT_SECURE_SESSION_ON) {
+        return LT_FAIL;
+    }
+    if (minClockHz == 0 || stepHz == 0 || rounds == 0 || maxClockHz < minClockHz) {
+        return LT_PARAM_ERR;
+    }
+
+    const SPISettings origSpiSettings = this->device.spi_settings;
+    const uint32_t origSpiClockHz = this->spiClockHz;
+
+    // Reference Chip ID, read at the clock which is expected to work.
+    struct lt_chip_id_t referenceChipId;
+    this->setSpiClock(minClockHz);
+    lt_ret_t ret = lt_get_info_chip_id(&this->handle, &referenceChipId);
+    if (ret != LT_OK) {
+        this->device.spi_settings = origSpiSettings;
+        this->spiClockHz = origSpiClockHz;
+        return ret;
+    }
+
+    uint32_t stableClockHz = minClockHz;
+    uint32_t stableSteps = 0;
+    while (maxClockHz - stableClockHz >= stepHz) {
+        this->setSpiClock(stableClockHz + stepHz);
+        if (this->checkSpiRoundTrips(referenceChipId, rounds) != LT_OK) {
+            break;
+        }
+        stableClockHz += stepHz;
+        stableSteps++;
+    }
+
+    const uint32_t margin = (marginSteps < stableSteps) ? marginSteps : stableSteps;
+    this->setSpiClock(stableClockHz - margin * stepHz);
+
+    // Also resynchronizes with TROPIC01 after the failed frames at the unstable clock.
+    ret = this->checkSpiRoundTrips(referenceChipId, rounds);
+    if (ret != LT_OK) {
+        this->device.spi_settings = origSpiSettings;
+        this->spiClockHz = origSpiClockHz;
+        return ret;
+    }
+
+    clockHz = this->spiClockHz;
+    return LT_OK;
+}
+
+void Tropic01::setBusyRetryPolicy(const BusyRetryPolicy &policy) { this->busyRetryPolicy = policy; }
+
+const Tropic01::BusyRetryPolicy &Tropic01::getBusyRetryPolicy(void) const { return this->busyRetryPolicy; }
+
+void Tropic01::traceEnable(TraceEntry buffer[], const uint16_t entriesCount)
+{
+    // An empty buffer disables tracing, so traceRecord() never indexes or wraps around zero records.
+    this->traceBuffer = entriesCount ? buffer : nullptr;
+    this->traceBufferLen = this->traceBuffer ? entriesCount : 0;
+    this->traceHead = 0;
+    this->traceCount = 0;
+}
+
+void Tropic01::traceDisable(void) { this->traceEnable(nullptr, 0); }
+
+uint16_t Tropic01::traceDump(Print &out) const
+{
+    const uint8_t header[] = {TRACE_DUMP_MAGIC[0],
+                              TRACE_DUMP_MAGIC[1],
+                              TRACE_DUMP_MAGIC[2],
+                              TRACE_DUMP_MAGIC[3],
+                              TRACE_DUMP_VERSION,
+                              TRACE_DUMP_ENTRY_LEN,
+                              (uint8_t)(this->traceCount & 0xff),
+                              (uint8_t)(this->traceCount >> 8)};
+    out.write(header, sizeof(header));
+
+    // The oldest record is at traceHead once the buffer has wrapped around.
+    const uint16_t first = (this->traceCount == this->traceBufferLen) ? this->traceHead : 0;
+    for (uint16_t i = 0; i < this->traceCount; i++) {
+        const TraceEntry &entry = this->traceBuffer[(first + i) % this->traceBufferLen];
+        const uint8_t record[TRACE_DUMP_ENTRY_LEN] = {(uint8_t)(entry.timestampUs & 0xff),
+                                                      (uint8_t)((entry.timestampUs >> 8) & 0xff),
+                                                      (uint8_t)((entry.timestampUs >> 16) & 0xff),
+                                                      (uint8_t)(entry.timestampUs >> 24),
+                                                      (uint8_t)(entry.len & 0xff),
+                                                      (uint8_t)(entry.len >> 8),
+                                                      entry.kind,
+                                                      entry.status};
+        out.write(record, sizeof(record));
+    }
+
+    return this->traceCount;
+}
+
+lt_ret_t Tropic01::secureSessionStart(const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex,
+                                      HandshakeTiming *timing)
+{
+    const uint32_t startUs = micros();
+    memset(&this->handshakeTiming, 0, sizeof(this->handshakeTiming));
+
+    lt_ret_t sessionRet = this->runCommand(COMMAND_TYPE_SESSION, [&]() {
+        struct lt_chip_id_t chipId;
+        const uint32_t chipIdStartUs = micros();
+        lt_ret_t ret = lt_get_info_chip_id(&this->handle, &chipId);
+        this->handshakeTiming.chipIdUs += elapsedUs(chipIdStartUs);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        if (this->chipIdentityValid
+            && memcmp(&chipId, &this->chipIdentity.chipId, sizeof(this->chipIdentity.chipId)) == 0) {
+            ret = this->handshake(this->chipIdentity.stPub, shiPriv, shiPub, pkeyIndex);
+            if (ret == LT_OK) {
+                return ret;
+            }
+            // The cached key might be stale, verify the chip again.
+        }
+
+        ret = this->verifyChipId(chipId);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        return this->handshake(this->chipIdentity.stPub, shiPriv, shiPub, pkeyIndex);
+    });
+
+    this->updateSessionKeys(sessionRet, shiPriv, shiPub, pkeyIndex);
+    this->finishHandshakeTiming(startUs, sessionRet, timing);
+
+    return sessionRet;
+}
+
+lt_ret_t Tropic01::verifyChip(ChipIdentity &identity)
+{
+    return this->runCommand(COMMAND_TYPE_SESSION, [&]() {
+        struct lt_chip_id_t chipId;
+        lt_ret_t ret = lt_get_info_chip_id(&this->handle, &chipId);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        ret = this->verifyChipId(chipId);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        identity = this->chipIdentity;
+
+        return LT_OK;
+    });
+}
+
+lt_ret_t Tropic01::startSession(const uint8_t stPub[], const uint8_t shiPriv[], const uint8_t shiPub[],
+                                const lt_pkey_index_t pkeyIndex, HandshakeTiming *timing)
+{
+    const uint32_t startUs = micros();
+    memset(&this->handshakeTiming, 0, sizeof(this->handshakeTiming));
+
+    lt_ret_t ret = this->runCommand(COMMAND_TYPE_SESSION,
+                                    [&]() { return this->handshake(stPub, shiPriv, shiPub, pkeyIndex); });
+
+    this->updateSessionKeys(ret, shiPriv, shiPub, pkeyIndex);
+    this->finishHandshakeTiming(startUs, ret, timing);
+
+    return ret;
+}
+
+const Tropic01::HandshakeStats &Tropic01::getHandshakeStats(void) const { return this->handshakeStats; }
+
+void Tropic01::resetHandshakeStats(void)
+{
+    memset(&this->handshakeStats, 0, sizeof(this->handshakeStats));
+    memset(&this->handshakeSums, 0, sizeof(this->handshakeSums));
+}
+
+lt_ret_t Tropic01::prepareSession(void)
+{
+    if (this->ephKeysCount >= EPH_KEYS_POOL_LEN) {
+        return LT_OK;
+    }
+
+    lt_ret_t ret = generateEphKeys(this->ephKeysPool[this->ephKeysCount]);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    this->ephKeysCount++;
+
+    return LT_OK;
+}
+
+uint8_t Tropic01::getPreparedSessionCount(void) const { return this->ephKeysCount; }
+
+bool Tropic01::getChipIdentity(ChipIdentity &identity) const
+{
+    if (!this->chipIdentityValid) {
+        return false;
+    }
+    identity = this->chipIdentity;
+    return true;
+}
+
+void Tropic01::setChipIdentity(const ChipIdentity &identity)
+{
+    this->chipIdentity = identity;
+    this->chipIdentityValid = true;
+}
+
+void Tropic01::clearChipIdentity(void)
+{
+    memset(&this->chipIdentity, 0, sizeof(this->chipIdentity));
+    this->chipIdentityValid = false;
+}
+
+void Tropic01::setAutoRecovery(const bool enable) { this->autoRecovery = enable; }
+
+const Tropic01::RecoveryStats &Tropic01::getRecoveryStats(void) const { return this->recoveryStats; }
+
+void Tropic01::resetRecoveryStats(void) { memset(&this->recoveryStats, 0, sizeof(this->recoveryStats)); }
+
+void Tropic01::setSessionIdleTimeout(const uint32_t timeoutMs) { this->sessionIdleTimeoutMs = timeoutMs; }
+
+lt_ret_t Tropic01::sessionPoll(void)
+{
+    // Only sessions which can be opened again are closed.
+    if (this->sessionIdleTimeoutMs == 0 || this->sessionIdleClosed || !this->sessionShiPriv
+        || this->handle.l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_OK;
+    }
+    if ((uint32_t)(millis() - this->sessionLastActivityMs) < this->sessionIdleTimeoutMs) {
+        return LT_OK;
+    }
+
+    this->sessionIdleClosed = true;
+    return lt_session_abort(&this->handle);
+}
+
+lt_ret_t Tropic01::expectActivity(void)
+{
+    this->sessionLastActivityMs = millis();
+    return this->reopenIdleSession();
+}
+
+lt_ret_t Tropic01::registerIdentity(const uint8_t index, const uint8_t shiPriv[], const uint8_t shiPub[],
+                                    const lt_pkey_index_t pkeyIndex)
+{
+    if (index >= MAX_IDENTITIES || !shiPriv || !shiPub) {
+        return LT_PARAM_ERR;
+    }
+
+    this->identities[index].shiPriv = shiPriv;
+    this->identities[index].shiPub = shiPub;
+    this->identities[index].pkeyIndex = pkeyIndex;
+
+    return LT_OK;
+}
+
+lt_ret_t Tropic01::useIdentity(const uint8_t index)
+{
+    if (index >= MAX_IDENTITIES || !this->identities[index].shiPriv) {
+        return LT_PARAM_ERR;
+    }
+    const PairingIdentity &identity = this->identities[index];
+
+    const bool sessionOn = (this->handle.l3.session_status == LT_SECURE_SESSION_ON);
+    if (sessionOn && this->sessionShiPriv == identity.shiPriv && this->sessionPkeyIndex == identity.pkeyIndex) {
+        return LT_OK;
+    }
+    // Forget the current identity first, so neither auto-recovery nor an idle re-open can return to it when the
+    // switch fails.
+    this->forgetSessionKeys();
+    if (sessionOn) {
+        lt_ret_t ret = lt_session_abort(&this->handle);
+        if (ret != LT_OK) {
+            lt_l3_invalidate_host_session_data(&this->handle.l3);
+            return ret;
+        }
+    }
+
+    if (this->chipIdentityValid) {
+        lt_ret_t ret = this->startSession(this->chipIdentity.stPub, identity.shiPriv, identity.shiPub,
+                                          identity.pkeyIndex);
+        if (ret == LT_OK) {
+            return ret;
+        }
+        // The cached key might be stale. Forget it, so secureSessionStart() verifies the chip again instead of
+        // repeating the handshake with the same key.
+        this->clearChipIdentity();
+    }
+
+    return this->secureSessionStart(identity.shiPriv, identity.shiPub, identity.pkeyIndex);
+}
+
+lt_ret_t Tropic01::secureSessionEnd(void)
+{
+    this->forgetSessionKeys();
+    return lt_session_abort(&this->handle);
+}
+
+Tropic01::Session::Session(Tropic01 &chip, const uint8_t shiPriv[], const uint8_t shiPub[],
+                           const lt_pkey_index_t pkeyIndex)
+    : tropic01(&chip)
+{
+    this->ret = chip.secureSessionStart(shiPriv, shiPub, pkeyIndex);
+}
+
+Tropic01::Session::Session(Session &&other) : tropic01(other.tropic01), ret(other.ret) { other.tropic01 = nullptr; }
+
+Tropic01::Session &Tropic01::Session::operator=(Session &&other)
+{
+    if (this != &other) {
+        this->end();
+        this->tropic01 = other.tropic01;
+        this->ret = other.ret;
+        other.tropic01 = nullptr;
+    }
+    return *this;
+}
+
+Tropic01::Session::~Session() { this->end(); }
+
+bool Tropic01::Session::active(void) const
+{
+    return this->tropic01 && this->ret == LT_OK
+           && (this->tropic01->handle.l3.session_status == LT_SECURE_SESSION_ON || this->tropic01->sessionIdleClosed);
+}
+
+lt_ret_t Tropic01::Session::status(void) const { return this->ret; }
+
+lt_ret_t Tropic01::Session::end(void)
+{
+    Tropic01 *chip = this->tropic01;
+    this->tropic01 = nullptr;
+
+    // A guard which failed to start its session does not own the session which might be still active.
+    if (!chip || this->ret != LT_OK) {
+        return LT_OK;
+    }
+
+    // Do not send anything when the session was already closed.
+    if (chip->handle.l3.session_status != LT_SECURE_SESSION_ON) {
+        chip->forgetSessionKeys();
+        return LT_OK;
+    }
+    return chip->secureSessionEnd();
+}
 
 lt_ret_t Tropic01::ping(const char msgOut[], char msgIn[], const uint16_t msgLen)
 {
-    return lt_ping(&this->handle, (uint8_t *)msgOut, (uint8_t *)msgIn, msgLen);
+    return this->runSessionCommand(COMMAND_TYPE_FAST, [&]() {
+        return lt_ping(&this->handle, (uint8_t *)msgOut, (uint8_t *)msgIn, msgLen);
+    });
 }
 
 lt_ret_t Tropic01::eccKeyGenerate(const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve)
 {
-    return lt_ecc_key_generate(&this->handle, slot, curve);
+    return this->runSessionCommand(COMMAND_TYPE_KEYGEN, [&]() {
+        return lt_ecc_key_generate(&this->handle, slot, curve);
+    });
 }
 
 lt_ret_t Tropic01::eccKeyStore(const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve, const uint8_t key[])
 {
-    return lt_ecc_key_store(&this->handle, slot, curve, key);
+    return this->runSessionCommand(COMMAND_TYPE_FAST, [&]() {
+        return lt_ecc_key_store(&this->handle, slot, curve, key);
+    });
 }
 
 lt_ret_t Tropic01::eccKeyRead(const lt_ecc_slot_t slot, uint8_t key[], const uint8_t keyMaxSize,
                               lt_ecc_curve_type_t &curve, lt_ecc_key_origin_t &origin)
 {
-    return lt_ecc_key_read(&this->handle, slot, key, keyMaxSize, &curve, &origin);
+    return this->runSessionCommand(COMMAND_TYPE_FAST, [&]() {
+        return lt_ecc_key_read(&this->handle, slot, key, keyMaxSize, &curve, &origin);
+    });
 }
 
-lt_ret_t Tropic01::eccKeyErase(const lt_ecc_slot_t slot) { return lt_ecc_key_erase(&this->handle, slot); }
+lt_ret_t Tropic01::eccKeyErase(const lt_ecc_slot_t slot)
+{
+    return this->runSessionCommand(COMMAND_TYPE_FAST, [&]() { return lt_ecc_key_erase(&this->handle, slot); });
+}
 
 lt_ret_t Tropic01::ecdsaSign(const lt_ecc_slot_t slot, const uint8_t msg[], const uint32_t msgLen, uint8_t rs[])
 {
-    return lt_ecc_ecdsa_sign(&this->handle, slot, msg, msgLen, rs);
+    return this->runSessionCommand(COMMAND_TYPE_SIGN, [&]() {
+        return lt_ecc_ecdsa_sign(&this->handle, slot, msg, msgLen, rs);
+    });
+}
+
+lt_ret_t Tropic01::ecdsaSignStart(void)
+{
+    if (this->signHashActive) {
+        psa_hash_abort(&this->signHashOp);
+    }
+    this->signHashOp = psa_hash_operation_init();
+    this->signHashActive = (psa_hash_setup(&this->signHashOp, PSA_ALG_SHA_256) == PSA_SUCCESS);
+
+    return this->signHashActive ? LT_OK : LT_CRYPTO_ERR;
+}
+
+lt_ret_t Tropic01::ecdsaSignUpdate(const uint8_t chunk[], const uint32_t chunkLen)
+{
+    if (!this->signHashActive) {
+        return LT_FAIL;
+    }
+    if (psa_hash_update(&this->signHashOp, chunk, chunkLen) != PSA_SUCCESS) {
+        psa_hash_abort(&this->signHashOp);
+        this->signHashActive = false;
+        return LT_CRYPTO_ERR;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t Tropic01::ecdsaSignFinish(const lt_ecc_slot_t slot, uint8_t rs[])
+{
+    if (!this->signHashActive) {
+        return LT_FAIL;
+    }
+    this->signHashActive = false;
+
+    uint8_t digest[SHA256_DIGEST_LEN];
+    size_t hashLen;
+    if (psa_hash_finish(&this->signHashOp, digest, sizeof(digest), &hashLen) != PSA_SUCCESS) {
+        psa_hash_abort(&this->signHashOp);
+        return LT_CRYPTO_ERR;
+    }
+
+    return this->ecdsaSignDigest(slot, digest, rs);
+}
+
+lt_ret_t Tropic01::ecdsaSignDigest(const lt_ecc_slot_t slot, const uint8_t digest[], uint8_t rs[])
+{
+    return this->runSessionCommand(COMMAND_TYPE_SIGN, [&]() {
+        memcpy(ecdsaSignCmd(this->handle.l3.buff)->msg_hash, digest, SHA256_DIGEST_LEN);
+        lt_ret_t ret = this->signSendPayload(TR01_L3_ECDSA_SIGN_CMD_ID, slot, SHA256_DIGEST_LEN);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        return this->signReceive(rs);
+    });
+}
+
+lt_ret_t Tropic01::ecdsaSignBatch(const lt_ecc_slot_t slot, const uint8_t *const msgs[], const uint32_t msgLens[],
+                                  const uint16_t count, uint8_t *const sigs[], lt_ret_t rets[])
+{
+    if (!msgs || !msgLens || !sigs || !rets) {
+        return LT_PARAM_ERR;
+    }
+    if (count == 0) {
+        return LT_OK;
+    }
+
+    // Digest of the current message and the next one, which is computed while TROPIC01 signs the current one.
+    uint8_t digests[2][SHA256_DIGEST_LEN];
+    uint8_t cur = 0;
+    lt_ret_t hashRet = hashMessage(msgs[0], msgLens[0], digests[cur]);
+    lt_ret_t result = LT_OK;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const bool hasNext = (i + 1 < count);
+        bool nextHashed = false;
+        lt_ret_t nextHashRet = LT_OK;
+
+        rets[i] = hashRet;
+        if (rets[i] == LT_OK) {
+            rets[i] = this->runSessionCommand(COMMAND_TYPE_SIGN, [&]() {
+                memcpy(ecdsaSignCmd(this->handle.l3.buff)->msg_hash, digests[cur], SHA256_DIGEST_LEN);
+                lt_ret_t ret = this->signSendPayload(TR01_L3_ECDSA_SIGN_CMD_ID, slot, SHA256_DIGEST_LEN);
+                if (ret != LT_OK) {
+                    return ret;
+                }
+                if (hasNext && !nextHashed) {
+                    nextHashRet = hashMessage(msgs[i + 1], msgLens[i + 1], digests[cur ^ 1]);
+                    nextHashed = true;
+                }
+                return this->signReceive(sigs[i]);
+            });
+        }
+        if (rets[i] != LT_OK && result == LT_OK) {
+            result = rets[i];
+        }
+
+        if (hasNext) {
+            if (!nextHashed) {
+                nextHashRet = hashMessage(msgs[i + 1], msgLens[i + 1], digests[cur ^ 1]);
+            }
+            hashRet = nextHashRet;
+            cur ^= 1;
+        }
+    }
+
+    return result;
+}
+
+lt_ret_t Tropic01::ecdsaSign(const lt_ecc_slot_t slot, const uint8_t msg[], const uint32_t msgLen, uint8_t sig[],
+                             uint8_t &sigLen, const SignatureFormat format)
+{
+    lt_ret_t ret = this->ecdsaSign(slot, msg, msgLen, rawSignature(sig, format));
+    if (ret == LT_OK) {
+        formatSignature(sig, sigLen, format);
+    }
+
+    return ret;
+}
+
+lt_ret_t Tropic01::ecdsaSignDigest(const lt_ecc_slot_t slot, const uint8_t digest[], uint8_t sig[], uint8_t &sigLen,
+                                   const SignatureFormat format)
+{
+    lt_ret_t ret = this->ecdsaSignDigest(slot, digest, rawSignature(sig, format));
+    if (ret == LT_OK) {
+        formatSignature(sig, sigLen, format);
+    }
+
+    return ret;
+}
+
+lt_ret_t Tropic01::ecdsaSignFinish(const lt_ecc_slot_t slot, uint8_t sig[], uint8_t &sigLen,
+                                   const SignatureFormat format)
+{
+    lt_ret_t ret = this->ecdsaSignFinish(slot, rawSignature(sig, format));
+    if (ret == LT_OK) {
+        formatSignature(sig, sigLen, format);
+    }
+
+    return ret;
 }
 
 lt_ret_t Tropic01::eddsaSign(const lt_ecc_slot_t slot, const uint8_t msg[], const uint16_t msgLen, uint8_t rs[])
 {
-    return lt_ecc_eddsa_sign(&this->handle, slot, msg, msgLen, rs);
+    return this->runSessionCommand(COMMAND_TYPE_SIGN, [&]() {
+        return lt_ecc_eddsa_sign(&this->handle, slot, msg, msgLen, rs);
+    });
+}
+
+lt_ret_t Tropic01::eddsaSignSource(const lt_ecc_slot_t slot, MessageSource source, void *ctx, const uint16_t msgLen,
+                                   uint8_t rs[], const uint16_t chunkLen)
+{
+    uint16_t maxLen;
+    uint8_t *msg = this->eddsaSignBuffer(maxLen);
+    if (!source || chunkLen == 0 || msgLen == 0 || msgLen > maxLen) {
+        return LT_PARAM_ERR;
+    }
+
+    return this->runSessionCommand(COMMAND_TYPE_SIGN, [&]() {
+        // The L3 buffer is encrypted in place, so the message is read again on every attempt.
+        for (uint16_t offset = 0; offset < msgLen;) {
+            const uint16_t len = (msgLen - offset < chunkLen) ? msgLen - offset : chunkLen;
+            lt_ret_t ret = source(ctx, offset, &msg[offset], len);
+            if (ret != LT_OK) {
+                return ret;
+            }
+            offset += len;
+        }
+
+        lt_ret_t ret = this->signSendPayload(TR01_L3_EDDSA_SIGN_CMD_ID, slot, msgLen);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        return this->signReceive(rs);
+    });
 }
 
 lt_ret_t Tropic01::rMemWrite(const uint16_t udataSlot, const uint8_t data[], const uint16_t dataSize)
 {
-    return lt_r_mem_data_write(&this->handle, udataSlot, data, dataSize);
+    return this->runSessionCommand(COMMAND_TYPE_R_MEM, [&]() {
+        return lt_r_mem_data_write(&this->handle, udataSlot, data, dataSize);
+    });
 }
 
 lt_ret_t Tropic01::rMemRead(const uint16_t udataSlot, uint8_t data[], const uint16_t dataMaxSize,
                             uint16_t &dataReadSize)
 {
-    return lt_r_mem_data_read(&this->handle, udataSlot, data, dataMaxSize, &dataReadSize);
+    return this->runSessionCommand(COMMAND_TYPE_R_MEM, [&]() {
+        return lt_r_mem_data_read(&this->handle, udataSlot, data, dataMaxSize, &dataReadSize);
+    });
 }
 
-lt_ret_t Tropic01::rMemErase(const uint16_t udataSlot) { return lt_r_mem_data_erase(&this->handle, udataSlot); }
+lt_ret_t Tropic01::rMemErase(const uint16_t udataSlot)
+{
+    return this->runSessionCommand(COMMAND_TYPE_R_MEM, [&]() { return lt_r_mem_data_erase(&this->handle, udataSlot); });
+}
 
 lt_ret_t Tropic01::macAndDestroy(const lt_mac_and_destroy_slot_t slot, const uint8_t dataOut[], uint8_t dataIn[])
 {
-    return lt_mac_and_destroy(&this->handle, slot, dataOut, dataIn);
+    return this->runSessionCommand(COMMAND_TYPE_FAST, [&]() {
+        return lt_mac_and_destroy(&this->handle, slot, dataOut, dataIn);
+    });
+}
+
+uint8_t *Tropic01::pingBuffer(uint16_t &maxLen)
+{
+    maxLen = (this->l3CmdPayloadMaxLen() < PING_LEN_MAX) ? this->l3CmdPayloadMaxLen() : PING_LEN_MAX;
+    return this->l3CmdPayload();
+}
+
+lt_ret_t Tropic01::pingInPlace(const uint16_t msgLen, const uint8_t *&msgIn)
+{
+    if (msgLen > PING_LEN_MAX) {
+        return LT_PARAM_ERR;
+    }
+
+    return this->runCommand(COMMAND_TYPE_FAST, [&]() {
+        lt_ret_t ret = this->l3Send(TR01_L3_PING_CMD_ID, msgLen);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        uint16_t resPayloadLen;
+        ret = this->l3Receive(msgIn, resPayloadLen);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (resPayloadLen != msgLen) {
+            return LT_FAIL;
+        }
+
+        return LT_OK;
+    });
+}
+
+uint8_t *Tropic01::rMemWriteBuffer(uint16_t &maxLen)
+{
+    const uint16_t bufferMaxLen = this->l3CmdPayloadMaxLen() - SLOT_CMD_DATA_OFFSET;
+    maxLen = (bufferMaxLen < R_MEM_DATA_LEN_MAX) ? bufferMaxLen : R_MEM_DATA_LEN_MAX;
+    return &this->l3CmdPayload()[SLOT_CMD_DATA_OFFSET];
+}
+
+lt_ret_t Tropic01::rMemWriteInPlace(const uint16_t udataSlot, const uint16_t dataSize)
+{
+    if (dataSize == 0 || dataSize > R_MEM_DATA_LEN_MAX) {
+        return LT_PARAM_ERR;
+    }
+
+    return this->runCommand(COMMAND_TYPE_R_MEM, [&]() {
+        uint8_t *payload = this->l3CmdPayload();
+        payload[0] = udataSlot & 0xff;
+        payload[1] = udataSlot >> 8;
+        payload[2] = 0;
+
+        lt_ret_t ret = this->l3Send(TR01_L3_R_MEM_DATA_WRITE_CMD_ID, SLOT_CMD_DATA_OFFSET + dataSize);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        const uint8_t *resPayload;
+        uint16_t resPayloadLen;
+        return this->l3Receive(resPayload, resPayloadLen);
+    });
+}
+
+lt_ret_t Tropic01::rMemReadInPlace(const uint16_t udataSlot, const uint8_t *&data, uint16_t &dataReadSize)
+{
+    return this->runCommand(COMMAND_TYPE_R_MEM, [&]() {
+        uint8_t *payload = this->l3CmdPayload();
+        payload[0] = udataSlot & 0xff;
+        payload[1] = udataSlot >> 8;
+
+        lt_ret_t ret = this->l3Send(TR01_L3_R_MEM_DATA_READ_CMD_ID, 2);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        const uint8_t *resPayload;
+        uint16_t resPayloadLen;
+        ret = this->l3Receive(resPayload, resPayloadLen);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (resPayloadLen < SLOT_RES_DATA_OFFSET) {
+            return LT_FAIL;
+        }
+        data = &resPayload[SLOT_RES_DATA_OFFSET];
+        dataReadSize = resPayloadLen - SLOT_RES_DATA_OFFSET;
+
+        return LT_OK;
+    });
+}
+
+uint8_t *Tropic01::eddsaSignBuffer(uint16_t &maxLen)
+{
+    const uint16_t bufferMaxLen = this->l3CmdPayloadMaxLen() - EDDSA_CMD_MSG_OFFSET;
+    maxLen = (bufferMaxLen < EDDSA_MSG_LEN_MAX) ? bufferMaxLen : EDDSA_MSG_LEN_MAX;
+    return eddsaSignCmd(this->handle.l3.buff)->msg;
+}
+
+lt_ret_t Tropic01::eddsaSignInPlace(const lt_ecc_slot_t slot, const uint16_t msgLen, uint8_t rs[])
+{
+    if (msgLen == 0 || msgLen > EDDSA_MSG_LEN_MAX) {
+        return LT_PARAM_ERR;
+    }
+
+    return this->runCommand(COMMAND_TYPE_SIGN, [&]() {
+        lt_ret_t ret = this->signSendPayload(TR01_L3_EDDSA_SIGN_CMD_ID, slot, msgLen);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        return this->signReceive(rs);
+    });
+}
+
+uint8_t *Tropic01::macAndDestroyBuffer(void) { return &this->l3CmdPayload()[SLOT_CMD_DATA_OFFSET]; }
+
+lt_ret_t Tropic01::macAndDestroyInPlace(const lt_mac_and_destroy_slot_t slot, const uint8_t *&dataIn)
+{
+    return this->runCommand(COMMAND_TYPE_FAST, [&]() {
+        uint8_t *payload = this->l3CmdPayload();
+        payload[0] = slot & 0xff;
+        payload[1] = slot >> 8;
+        payload[2] = 0;
+
+        lt_ret_t ret = this->l3Send(TR01_L3_MAC_AND_DESTROY_CMD_ID, SLOT_CMD_DATA_OFFSET + MAC_AND_DESTROY_DATA_LEN);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        const uint8_t *resPayload;
+        uint16_t resPayloadLen;
+        ret = this->l3Receive(resPayload, resPayloadLen);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (resPayloadLen != SLOT_RES_DATA_OFFSET + MAC_AND_DESTROY_DATA_LEN) {
+            return LT_FAIL;
+        }
+        dataIn = &resPayload[SLOT_RES_DATA_OFFSET];
+
+        return LT_OK;
+    });
+}
+
+void Tropic01::traceRecord(const TraceKind kind, const uint16_t len, const uint8_t status)
+{
+    if (!this->traceBuffer) {
+        return;
+    }
+
+    TraceEntry &entry = this->traceBuffer[this->traceHead];
+    entry.timestampUs = micros();
+    entry.len = len;
+    entry.kind = kind;
+    entry.status = status;
+
+    this->traceHead = (this->traceHead + 1) % this->traceBufferLen;
+    if (this->traceCount < this->traceBufferLen) {
+        this->traceCount++;
+    }
+}
+
+void Tropic01::rememberSessionKeys(const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex)
+{
+    this->sessionShiPriv = shiPriv;
+    this->sessionShiPub = shiPub;
+    this->sessionPkeyIndex = pkeyIndex;
+    this->sessionLastActivityMs = millis();
+    this->sessionIdleClosed = false;
+}
+
+void Tropic01::forgetSessionKeys(void)
+{
+    this->sessionShiPriv = nullptr;
+    this->sessionShiPub = nullptr;
+    this->sessionPkeyIndex = TR01_PAIRING_KEY_SLOT_INDEX_0;
+    this->sessionIdleClosed = false;
+}
+
+void Tropic01::updateSessionKeys(const lt_ret_t startRet, const uint8_t shiPriv[], const uint8_t shiPub[],
+                                 const lt_pkey_index_t pkeyIndex)
+{
+    if (startRet == LT_OK) {
+        this->rememberSessionKeys(shiPriv, shiPub, pkeyIndex);
+    }
+    else if (shiPriv != this->sessionShiPriv || pkeyIndex != this->sessionPkeyIndex) {
+        // A failed start with other keys must not be followed by a recovery to the previous identity.
+        this->forgetSessionKeys();
+    }
+}
+
+lt_ret_t Tropic01::reopenIdleSession(void)
+{
+    if (!this->sessionIdleClosed) {
+        return LT_OK;
+    }
+
+    return this->secureSessionStart(this->sessionShiPriv, this->sessionShiPub, this->sessionPkeyIndex);
+}
+
+lt_ret_t Tropic01::handshake(const uint8_t stPub[], const uint8_t shiPriv[], const uint8_t shiPub[],
+                             const lt_pkey_index_t pkeyIndex)
+{
+    // Same check as in lt_out__session_start(), done before a prepared key pair is consumed.
+    if (!stPub || !shiPriv || !shiPub || pkeyIndex > TR01_PAIRING_KEY_SLOT_INDEX_3) {
+        return LT_PARAM_ERR;
+    }
+
+    // Take a prepared key pair if there is one, each is used only once.
+    lt_host_eph_keys_t ephKeys;
+    lt_ret_t ret;
+    if (this->ephKeysCount > 0) {
+        this->ephKeysCount--;
+        ephKeys = this->ephKeysPool[this->ephKeysCount];
+        mbedtls_platform_zeroize(&this->ephKeysPool[this->ephKeysCount], sizeof(ephKeys));
+    }
+    else {
+        const uint32_t ephKeysStartUs = micros();
+        ret = generateEphKeys(ephKeys);
+        this->handshakeTiming.ephKeysUs += elapsedUs(ephKeysStartUs);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    // TROPIC01 drops its current session on Handshake_Req, so the host one is dropped too, as in
+    // lt_out__session_start(). A failed handshake then leaves no session instead of a stale one.
+    lt_l3_invalidate_host_session_data(&this->handle.l3);
+
+    // Same request as built by lt_out__session_start(), just with the key pair from above.
+    struct lt_l2_handshake_req_t *req = (struct lt_l2_handshake_req_t *)this->handle.l2.buff;
+    req->req_id = TR01_L2_HANDSHAKE_REQ_ID;
+    req->req_len = TR01_L2_HANDSHAKE_REQ_LEN;
+    memcpy(req->e_hpub, ephKeys.ehpub, sizeof(req->e_hpub));
+    req->pkey_index = pkeyIndex;
+
+    const uint32_t handshakeStartUs = micros();
+    ret = lt_l2_send(&this->handle.l2);
+    if (ret == LT_OK) {
+        ret = this->pollResponse([&]() { return lt_l2_receive(&this->handle.l2); });
+    }
+    this->handshakeTiming.handshakeUs += elapsedUs(handshakeStartUs);
+
+    if (ret == LT_OK) {
+        const uint32_t hostKeysStartUs = micros();
+        ret = lt_in__session_start(&this->handle, stPub, pkeyIndex, shiPriv, shiPub, &ephKeys);
+        this->handshakeTiming.hostKeysUs += elapsedUs(hostKeysStartUs);
+    }
+
+    mbedtls_platform_zeroize(&ephKeys, sizeof(ephKeys));
+    return ret;
+}
+
+void Tropic01::finishHandshakeTiming(const uint32_t startUs, const lt_ret_t ret, HandshakeTiming *timing)
+{
+    HandshakeTiming &last = this->handshakeTiming;
+    last.totalUs = elapsedUs(startUs);
+    if (timing) {
+        *timing = last;
+    }
+    if (ret != LT_OK) {
+        return;
+    }
+
+    HandshakeStats &stats = this->handshakeStats;
+    HandshakeSums &sums = this->handshakeSums;
+    stats.count++;
+    updateStat(stats.min.chipIdUs, stats.avg.chipIdUs, stats.max.chipIdUs, sums.chipIdUs, last.chipIdUs, stats.count);
+    updateStat(stats.min.certStoreUs, stats.avg.certStoreUs, stats.max.certStoreUs, sums.certStoreUs, last.certStoreUs,
+               stats.count);
+    updateStat(stats.min.stPubParseUs, stats.avg.stPubParseUs, stats.max.stPubParseUs, sums.stPubParseUs,
+               last.stPubParseUs, stats.count);
+    updateStat(stats.min.ephKeysUs, stats.avg.ephKeysUs, stats.max.ephKeysUs, sums.ephKeysUs, last.ephKeysUs,
+               stats.count);
+    updateStat(stats.min.handshakeUs, stats.avg.handshakeUs, stats.max.handshakeUs, sums.handshakeUs, last.handshakeUs,
+               stats.count);
+    updateStat(stats.min.hostKeysUs, stats.avg.hostKeysUs, stats.max.hostKeysUs, sums.hostKeysUs, last.hostKeysUs,
+               stats.count);
+    updateStat(stats.min.totalUs, stats.avg.totalUs, stats.max.totalUs, sums.totalUs, last.totalUs, stats.count);
+}
+
+void Tropic01::wipeEphKeysPool(void)
+{
+    mbedtls_platform_zeroize(this->ephKeysPool, sizeof(this->ephKeysPool));
+    this->ephKeysCount = 0;
+}
+
+uint16_t Tropic01::l3BuffLen(void) const
+{
+#if LT_SEPARATE_L3_BUFF
+    return this->handle.l3.buff_len;
+#else
+    return LT_SIZE_OF_L3_BUFF;
+#endif
+}
+
+uint16_t Tropic01::l3CmdPayloadMaxLen(void) const { return this->l3BuffLen() - L3_PAYLOAD_OFFSET - L3_TAG_LEN; }
+
+uint8_t *Tropic01::l3CmdPayload(void) { return &this->handle.l3.buff[L3_PAYLOAD_OFFSET]; }
+
+lt_ret_t Tropic01::l3Send(const uint8_t cmdId, const uint16_t payloadLen)
+{
+    // The handshake uses only the L2 buffer, so the payload already written into the L3 buffer is kept.
+    lt_ret_t ret = this->reopenIdleSession();
+    if (ret != LT_OK) {
+        return ret;
+    }
+    this->sessionLastActivityMs = millis();
+
+    if (this->handle.l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+    if (payloadLen > this->l3CmdPayloadMaxLen()) {
+        return LT_PARAM_ERR;
+    }
+
+    const uint16_t cmdSize = L3_ID_LEN + payloadLen;
+    this->handle.l3.buff[0] = cmdSize & 0xff;
+    this->handle.l3.buff[1] = cmdSize >> 8;
+    this->handle.l3.buff[L3_SIZE_LEN] = cmdId;
+
+    ret = lt_l3_encrypt_request(&this->handle.l3);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_send_encrypted_cmd(&this->handle.l2, this->handle.l3.buff, this->l3BuffLen());
+    this->traceRecord(TRACE_KIND_L3_TX, cmdSize, cmdId);
+
+    return ret;
+}
+
+lt_ret_t Tropic01::l3Receive(const uint8_t *&resPayload, uint16_t &resPayloadLen)
+{
+    lt_ret_t ret = this->pollResponse(
+        [&]() { return lt_l2_recv_encrypted_res(&this->handle.l2, this->handle.l3.buff, this->l3BuffLen()); });
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    // Also translates the RESULT field to lt_ret_t.
+    ret = lt_l3_decrypt_response(&this->handle.l3);
+    const uint16_t resSize = this->handle.l3.buff[0] | (this->handle.l3.buff[1] << 8);
+    this->traceRecord(TRACE_KIND_L3_RX, resSize, ret);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    if (resSize < L3_ID_LEN) {
+        return LT_FAIL;
+    }
+    resPayload = &this->handle.l3.buff[L3_PAYLOAD_OFFSET];
+    resPayloadLen = resSize - L3_ID_LEN;
+
+    return LT_OK;
+}
+
+lt_ret_t Tropic01::signSend(const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve, const uint8_t msg[],
+                            const uint32_t msgLen)
+{
+    uint16_t msgFieldLen;
+
+    if (curve == TR01_CURVE_P256) {
+        // ECDSA: the host sends SHA-256 digest of the message.
+        lt_ret_t ret = hashMessage(msg, msgLen, ecdsaSignCmd(this->handle.l3.buff)->msg_hash);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        msgFieldLen = SHA256_DIGEST_LEN;
+    }
+    else if (curve == TR01_CURVE_ED25519) {
+        if (msgLen == 0 || msgLen > EDDSA_MSG_LEN_MAX
+            || EDDSA_CMD_MSG_OFFSET + msgLen > this->l3CmdPayloadMaxLen()) {
+            return LT_PARAM_ERR;
+        }
+        memcpy(eddsaSignCmd(this->handle.l3.buff)->msg, msg, msgLen);
+        msgFieldLen = msgLen;
+    }
+    else {
+        return LT_PARAM_ERR;
+    }
+
+    return this->signSendPayload(
+        (curve == TR01_CURVE_P256) ? TR01_L3_ECDSA_SIGN_CMD_ID : TR01_L3_EDDSA_SIGN_CMD_ID, slot, msgFieldLen);
+}
+
+lt_ret_t Tropic01::signSendPayload(const uint8_t cmdId, const lt_ecc_slot_t slot, const uint16_t msgFieldLen)
+{
+    size_t cmdSize;
+
+    if (cmdId == TR01_L3_ECDSA_SIGN_CMD_ID) {
+        struct lt_l3_ecdsa_sign_cmd_t *cmd = ecdsaSignCmd(this->handle.l3.buff);
+        cmd->slot = slot;
+        memset(cmd->padding, 0, sizeof(cmd->padding));
+        cmdSize = offsetof(struct lt_l3_ecdsa_sign_cmd_t, msg_hash) + msgFieldLen;
+    }
+    else {
+        struct lt_l3_eddsa_sign_cmd_t *cmd = eddsaSignCmd(this->handle.l3.buff);
+        cmd->slot = slot;
+        memset(cmd->padding, 0, sizeof(cmd->padding));
+        cmdSize = offsetof(struct lt_l3_eddsa_sign_cmd_t, msg) + msgFieldLen;
+    }
+
+    return this->l3Send(cmdId, cmdSize - L3_PAYLOAD_OFFSET);
+}
+
+lt_ret_t Tropic01::signReceive(uint8_t rs[])
+{
+    const uint8_t *resPayload;
+    uint16_t resPayloadLen;
+
+    lt_ret_t ret = this->l3Receive(resPayload, resPayloadLen);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    // ECDSA_Sign and EdDSA_Sign responses have the same layout.
+    static_assert(sizeof(struct lt_l3_ecdsa_sign_res_t) == sizeof(struct lt_l3_eddsa_sign_res_t)
+                      && offsetof(struct lt_l3_ecdsa_sign_res_t, r) == offsetof(struct lt_l3_eddsa_sign_res_t, r),
+                  "ECDSA_Sign and EdDSA_Sign responses differ");
+    const struct lt_l3_ecdsa_sign_res_t *res = (const struct lt_l3_ecdsa_sign_res_t *)this->handle.l3.buff;
+    if (resPayloadLen + L3_ID_LEN != TR01_L3_ECDSA_SIGN_RES_SIZE) {
+        return LT_FAIL;
+    }
+    memcpy(rs, res->r, sizeof(res->r));
+    memcpy(&rs[sizeof(res->r)], res->s, sizeof(res->s));
+
+    return LT_OK;
+}
+
+lt_ret_t Tropic01::readStPub(uint8_t stPub[])
+{
+    uint8_t certs[LT_NUM_CERTIFICATES][TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE];
+    struct lt_cert_store_t store;
+
+    for (uint8_t i = 0; i < LT_NUM_CERTIFICATES; i++) {
+        store.certs[i] = certs[i];
+        store.buf_len[i] = sizeof(certs[i]);
+    }
+
+    const uint32_t certStoreStartUs = micros();
+    lt_ret_t ret = lt_get_info_cert_store(&this->handle, &store);
+    this->handshakeTiming.certStoreUs += elapsedUs(certStoreStartUs);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    const uint32_t stPubParseStartUs = micros();
+    ret = lt_get_st_pub(&store, stPub, ST_PUB_LEN);
+    this->handshakeTiming.stPubParseUs += elapsedUs(stPubParseStartUs);
+
+    return ret;
+}
+
+lt_ret_t Tropic01::verifyChipId(const struct lt_chip_id_t &chipId)
+{
+    this->clearChipIdentity();
+
+    lt_ret_t ret = this->readStPub(this->chipIdentity.stPub);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    this->chipIdentity.chipId = chipId;
+    this->chipIdentityValid = true;
+
+    return LT_OK;
+}
+
+lt_ret_t Tropic01::checkSpiRoundTrips(const struct lt_chip_id_t &referenceChipId, const uint16_t rounds)
+{
+    struct lt_chip_id_t chipId;
+
+    for (uint16_t round = 0; round < rounds; round++) {
+        lt_ret_t ret = lt_get_info_chip_id(&this->handle, &chipId);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (memcmp(&chipId, &referenceChipId, sizeof(chipId)) != 0) {
+            return LT_FAIL;
+        }
+    }
+
+    return LT_OK;
+}
+
+Tropic01Bus::Tropic01Bus()
+{
+    for (uint8_t i = 0; i < MAX_CHIPS; i++) {
+        this->chips[i] = nullptr;
+    }
+    this->chipsCount = 0;
+    this->resetStats();
+}
+
+lt_ret_t Tropic01Bus::add(Tropic01 &chip)
+{
+    if (this->isRegistered(&chip)) {
+        return LT_OK;
+    }
+    if (this->chipsCount >= MAX_CHIPS) {
+        return LT_PARAM_ERR;
+    }
+    if (this->chipsCount > 0 && chip.device.spi != this->chips[0]->device.spi) {
+        return LT_PARAM_ERR;
+    }
+
+    this->chips[this->chipsCount++] = &chip;
+    return LT_OK;
+}
+
+lt_ret_t Tropic01Bus::sign(Tropic01SignJob jobs[], const uint16_t jobsCount)
+{
+    for (uint16_t i = 0; i < jobsCount; i++) {
+        if (!this->isRegistered(jobs[i].chip) || !jobs[i].msg || !jobs[i].rs) {
+            return LT_PARAM_ERR;
+        }
+    }
+
+    const uint32_t startUs = micros();
+    lt_ret_t firstErr = LT_OK;
+    uint16_t next = 0;
+
+    while (next < jobsCount) {
+        // Group consecutive jobs which can be in flight at the same time: one per chip and L3 buffer.
+        uint16_t groupLen = 1;
+        while (next + groupLen < jobsCount && groupLen < MAX_CHIPS) {
+            const Tropic01 *candidate = jobs[next + groupLen].chip;
+            bool conflict = false;
+            for (uint16_t i = next; i < next + groupLen; i++) {
+                if (jobs[i].chip == candidate
+                    || &jobs[i].chip->handle.l3.buff[0] == &candidate->handle.l3.buff[0]) {
+                    conflict = true;
+                    break;
+                }
+            }
+            if (conflict) {
+                break;
+            }
+            groupLen++;
+        }
+
+        for (uint16_t i = next; i < next + groupLen; i++) {
+            Tropic01SignJob &job = jobs[i];
+            job.ret = job.chip->runSessionCommand(Tropic01::COMMAND_TYPE_SIGN, [&]() {
+                return job.chip->signSend(job.slot, job.curve, job.msg, job.msgLen);
+            });
+        }
+        for (uint16_t i = next; i < next + groupLen; i++) {
+            Tropic01SignJob &job = jobs[i];
+            if (job.ret == LT_OK) {
+                job.ret = job.chip->runCommand(Tropic01::COMMAND_TYPE_SIGN,
+                                               [&]() { return job.chip->signReceive(job.rs); });
+            }
+            if (job.ret == LT_OK) {
+                this->signatureCount++;
+            }
+            else if (firstErr == LT_OK) {
+                firstErr = job.ret;
+            }
+        }
+
+        next += groupLen;
+    }
+
+    this->elapsedUs += (uint32_t)(micros() - startUs);
+    return firstErr;
+}
+
+uint32_t Tropic01Bus::getSignatureCount(void) const { return this->signatureCount; }
+
+uint32_t Tropic01Bus::getThroughput(void) const
+{
+    if (this->elapsedUs == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)this->signatureCount * 1000000) / this->elapsedUs);
+}
+
+void Tropic01Bus::resetStats(void)
+{
+    this->signatureCount = 0;
+    this->elapsedUs = 0;
+}
+
+bool Tropic01Bus::isRegistered(const Tropic01 *chip) const
+{
+    for (uint8_t i = 0; i < this->chipsCount; i++) {
+        if (this->chips[i] == chip) {
+            return true;
+        }
+    }
+    return false;
 }
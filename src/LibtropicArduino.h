@@ -16,6 +16,9 @@
 #include "libtropic_common.h"
 #include "libtropic_mbedtls_v4.h"
 #include "libtropic_port_arduino.h"
+#include "psa/crypto.h"
+
+class Tropic01Bus;
 
 /**
  * @brief Instance of this class is used to communicate with one TROPIC01 chip.
@@ -23,6 +26,152 @@
  */
 class Tropic01 {
    public:
+    /**
+     * @brief Command types, recorded with every command by the trace (see traceEnable()).
+     *
+     */
+    enum CommandType {
+        COMMAND_TYPE_FAST = 0, /**< Ping, ECC key read/store/erase, MAC-and-Destroy */
+        COMMAND_TYPE_KEYGEN,   /**< ECC key generation */
+        COMMAND_TYPE_SIGN,     /**< ECDSA and EdDSA signing */
+        COMMAND_TYPE_R_MEM,    /**< R memory read/write/erase */
+        COMMAND_TYPE_SESSION,  /**< Secure Channel Session establishment */
+        COMMAND_TYPE_COUNT
+    };
+
+    /**
+     * @brief Policy for polling a response again when TROPIC01 was still busy (LT_L1_CHIP_BUSY).
+     * @details The request is never sent again, because TROPIC01 might have already executed it. Before the first
+     * retry, the command waits for `initialDelayMs`. Every next delay is multiplied by `backoffFactor` (1 = fixed
+     * delay, 2 = exponential backoff) and limited to `maxDelayMs`.
+     * @note The retries only follow after Libtropic's L1 layer gave up waiting for the response. How often L1 polls
+     * TROPIC01 before that is set by Libtropic and its HAL, not by this policy.
+     *
+     */
+    struct BusyRetryPolicy {
+        uint8_t maxRetries;      /**< Maximal number of retries, 0 disables retrying */
+        uint8_t backoffFactor;   /**< Multiplier applied to the delay after every retry */
+        uint16_t maxDelayMs;     /**< Upper limit of a single delay */
+        uint16_t initialDelayMs; /**< Delay before the first retry */
+    };
+
+    /**
+     * @brief Default BusyRetryPolicy: up to 3 retries with exponential backoff.
+     */
+    static const BusyRetryPolicy DEFAULT_BUSY_RETRY_POLICY;
+
+    /**
+     * @brief Kinds of records stored in the trace buffer.
+     *
+     */
+    enum TraceKind {
+        TRACE_KIND_CMD_START = 0, /**< Command started, `status` is its CommandType */
+        TRACE_KIND_CMD_END,       /**< Command finished, `status` is its lt_ret_t */
+        TRACE_KIND_L3_TX,         /**< L3 command sent, `len` is CMD_SIZE, `status` is CMD_ID */
+        TRACE_KIND_L3_RX          /**< L3 response received, `len` is RES_SIZE, `status` is lt_ret_t */
+    };
+
+    /**
+     * @brief One record of the trace buffer.
+     *
+     */
+    struct TraceEntry {
+        uint32_t timestampUs; /**< Value of micros() when the record was made */
+        uint16_t len;         /**< Frame length (0 if not applicable) */
+        uint8_t kind;         /**< One of TraceKind */
+        uint8_t status;       /**< Meaning depends on `kind` */
+    };
+
+    /** @brief Maximal number of ephemeral key pairs prepared by prepareSession(). */
+    static const uint8_t EPH_KEYS_POOL_LEN = 2;
+
+    /** @brief Maximal number of pairing identities registered by registerIdentity(). */
+    static const uint8_t MAX_IDENTITIES = 4;
+
+    /** @brief Length of TROPIC01's X25519 public key (STPUB). */
+    static const uint8_t ST_PUB_LEN = 32;
+
+    /**
+     * @brief Verified identity of a TROPIC01 chip: its Chip ID and the public key taken from its certificate store.
+     *
+     */
+    struct ChipIdentity {
+        struct lt_chip_id_t chipId; /**< Chip ID the public key belongs to */
+        uint8_t stPub[ST_PUB_LEN];  /**< TROPIC01's X25519 public key (STPUB) */
+    };
+
+    /**
+     * @brief Output format of ECDSA signatures.
+     *
+     */
+    enum SignatureFormat {
+        SIGNATURE_FORMAT_RAW = 0, /**< R and S bytes (64 bytes) */
+        SIGNATURE_FORMAT_DER      /**< ASN.1 DER encoded Ecdsa-Sig-Value (X.509, TLS, CMS), at most 72 bytes */
+    };
+
+    /**
+     * @brief Returns the maximal length of a signature in the given format, usable for buffer sizes at compile time.
+     *
+     * @param format[in]  Signature format
+     *
+     * @return            Maximal signature length in bytes
+     */
+    static constexpr uint8_t signatureMaxLen(const SignatureFormat format)
+    {
+        return (format == SIGNATURE_FORMAT_DER) ? 72 : TR01_ECDSA_EDDSA_SIGNATURE_LENGTH;
+    }
+
+    /**
+     * @brief Reads a part of a message signed by eddsaSignSource().
+     * @details The source must be re-readable: the same part can be requested more times (e.g. when the command is
+     * retried).
+     *
+     * @param ctx[in]     Context passed to eddsaSignSource()
+     * @param offset[in]  Offset of the part in the message
+     * @param buf[out]    Buffer for the part
+     * @param len[in]     Length of the part
+     *
+     * @retval            LT_OK The part was read
+     * @retval            other The message could not be read, the signature is aborted with this value
+     */
+    typedef lt_ret_t (*MessageSource)(void *ctx, const uint32_t offset, uint8_t buf[], const uint16_t len);
+
+    /**
+     * @brief Duration of individual phases of a Secure Channel Session establishment.
+     * @details Phases which were skipped (e.g. certificate store read when the ChipIdentity is cached) are 0.
+     *
+     */
+    struct HandshakeTiming {
+        uint32_t chipIdUs;     /**< Reading Chip ID to look up the ChipIdentity cache */
+        uint32_t certStoreUs;  /**< Reading the certificate store from TROPIC01 */
+        uint32_t stPubParseUs; /**< Parsing the certificates to get STPUB */
+        uint32_t ephKeysUs;    /**< Generating the host ephemeral key pair */
+        uint32_t handshakeUs;  /**< Handshake_Req and Handshake_Rsp exchange (SPI, waiting for TROPIC01) */
+        uint32_t hostKeysUs;   /**< Host-side X25519 operations and derivation of the session keys */
+        uint32_t totalUs;      /**< Whole method call */
+    };
+
+    /**
+     * @brief Running aggregate of HandshakeTiming over successful Secure Channel Session establishments.
+     *
+     */
+    struct HandshakeStats {
+        uint32_t count;      /**< Number of aggregated establishments */
+        HandshakeTiming min; /**< Minimum of every phase */
+        HandshakeTiming avg; /**< Average of every phase */
+        HandshakeTiming max; /**< Maximum of every phase */
+    };
+
+    /**
+     * @brief Statistics of the automatic Secure Channel Session recovery, see setAutoRecovery().
+     *
+     */
+    struct RecoveryStats {
+        uint32_t recoveries;       /**< Number of successfully restarted sessions */
+        uint32_t failedRecoveries; /**< Number of failed attempts to restart a session */
+        uint32_t recoveryTimeUs;   /**< Total time spent restarting sessions */
+    };
+
     /**
      * @brief Tropic01 constructor, which initializes internal structures.
      * @note Number of arguments depends on some Libtropic's CMake options.
@@ -76,18 +225,286 @@ class Tropic01 {
      */
     lt_ret_t end(void);
 
+    /**
+     * @brief Sets the SPI clock used for communication with TROPIC01.
+     * @details Data order and mode are kept at `MSBFIRST` and `SPI_MODE0` (required by TROPIC01). Can be called before
+     * begin(), e.g. to apply a clock found by calibrateSpiClock() on a previous boot.
+     *
+     * @param clockHz[in]  SPI clock in Hz
+     */
+    void setSpiClock(const uint32_t clockHz);
+
+    /**
+     * @brief Returns the SPI clock set by setSpiClock() or calibrateSpiClock().
+     *
+     * @return  SPI clock in Hz, 0 if the clock from the `spiSettings` constructor parameter is used
+     */
+    uint32_t getSpiClock(void) const;
+
+    /**
+     * @brief Searches for the fastest stable SPI clock and applies it.
+     * @details The clock is raised from `minClockHz` by `stepHz` up to `maxClockHz`. At every step, `rounds`
+     * round-trips are executed: TROPIC01's Chip ID is read and compared with a reference read at `minClockHz`. Any
+     * error or mismatch (e.g. a CRC error on L2) ends the search. The result is the last stable clock lowered by
+     * `marginSteps` steps. Store it (e.g. in EEPROM) and pass it to setSpiClock() on later boots to skip the
+     * calibration.
+     * @note begin() must be called before this method. Calibrate before secureSessionStart(), because a failed L3
+     * frame at an unstable clock would break the Secure Channel Session.
+     *
+     * @param clockHz[out]    Applied SPI clock in Hz
+     * @param minClockHz[in]  Starting clock in Hz, must be known to work
+     * @param maxClockHz[in]  Highest clock in Hz to try
+     * @param stepHz[in]      Clock increment in Hz
+     * @param marginSteps[in] Number of steps to go back from the fastest stable clock
+     * @param rounds[in]      Number of round-trips executed at every step
+     *
+     * @retval  LT_OK    Method executed successfully
+     * @retval  LT_FAIL  Not initialized, or a Secure Channel Session is established
+     * @retval  other    Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t calibrateSpiClock(uint32_t &clockHz, const uint32_t minClockHz = 1000000,
+                               const uint32_t maxClockHz = 20000000, const uint32_t stepHz = 1000000,
+                               const uint8_t marginSteps = 1, const uint16_t rounds = 8);
+
+    /**
+     * @brief Sets the policy for polling a response again when TROPIC01 was still busy.
+     * @note Applies to the handshake and to the commands whose L3 frames are built by this class (the in-place
+     * variants and the signing methods except ecdsaSign() and eddsaSign()). The other commands are polled only by
+     * Libtropic's L1 layer.
+     *
+     * @param policy[in]  New policy, DEFAULT_BUSY_RETRY_POLICY is used by default
+     */
+    void setBusyRetryPolicy(const BusyRetryPolicy &policy);
+
+    /**
+     * @brief Returns the policy for polling a response again when TROPIC01 was still busy.
+     *
+     * @return  Current policy
+     */
+    const BusyRetryPolicy &getBusyRetryPolicy(void) const;
+
+    /**
+     * @brief Enables recording of commands and L3 frames into a ring buffer.
+     * @details Recording only stores a few integers, nothing is formatted or printed, so the timing of the
+     * communication is affected as little as possible. When the buffer is full, the oldest records are overwritten.
+     *
+     * @param buffer[in]        User-defined buffer for the records, must be valid until traceDisable() is called
+     * @param entriesCount[in]  Number of records fitting into `buffer`, 0 disables tracing
+     */
+    void traceEnable(TraceEntry buffer[], const uint16_t entriesCount);
+
+    /**
+     * @brief Disables recording into the trace buffer.
+     */
+    void traceDisable(void);
+
+    /**
+     * @brief Writes the trace buffer in binary form, oldest record first.
+     * @details The output starts with a header: magic `LTTR`, version (1B), record size (1B) and record count (2B,
+     * little endian). Then the records follow, each as timestamp (4B), length (2B), kind (1B) and status (1B), all in
+     * little endian. Use `scripts/decode_trace.py` to turn the dump into a timeline.
+     *
+     * @param out[in]  Where to write the dump to (e.g. `Serial`)
+     *
+     * @return         Number of dumped records
+     */
+    uint16_t traceDump(Print &out) const;
+
     /**
      * @brief Establishes Secure Session Channel with TROPIC01.
+     * @details TROPIC01's public key is read from its certificate store only when the chip is seen for the first
+     * time. Afterwards, just the Chip ID is read and, if it matches the cached ChipIdentity, the cached public key is
+     * used directly for the handshake. If the handshake with the cached key fails, the cache is dropped and the
+     * certificate store is read again.
      *
      * @param shiPriv[in]     Host's private pairing key for the slot `pkeyIndex`
      * @param shiPub[in]      Host's public pairing key for the slot `pkeyIndex`
      * @param pkeyIndex[in]   Pairing key index
+     * @param timing[out]     Optional duration of the individual phases
      *
      * @retval                LT_OK Method executed successfully
      * @retval                other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
      * encoding of returned value
      */
-    lt_ret_t secureSessionStart(const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex);
+    lt_ret_t secureSessionStart(const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex,
+                                HandshakeTiming *timing = nullptr);
+
+    /**
+     * @brief Verifies TROPIC01: reads its Chip ID and takes its public key from the certificate store.
+     * @details The result is also stored into the ChipIdentity cache used by secureSessionStart(). Together with
+     * startSession(), this allows to do the expensive verification only once (e.g. at provisioning or boot) and
+     * reuse the result for many later sessions.
+     *
+     * @param identity[out]  Verified identity of the chip
+     *
+     * @retval               LT_OK Method executed successfully
+     * @retval               other Method did not execute successfully, you might use lt_ret_verbose() to get
+     * verbose encoding of returned value
+     */
+    lt_ret_t verifyChip(ChipIdentity &identity);
+
+    /**
+     * @brief Establishes Secure Session Channel with TROPIC01, whose public key is already known.
+     * @details Only the handshake is executed, TROPIC01 is not verified.
+     *
+     * @param stPub[in]       TROPIC01's public key (`ChipIdentity.stPub` returned by verifyChip())
+     * @param shiPriv[in]     Host's private pairing key for the slot `pkeyIndex`
+     * @param shiPub[in]      Host's public pairing key for the slot `pkeyIndex`
+     * @param pkeyIndex[in]   Pairing key index
+     * @param timing[out]     Optional duration of the individual phases
+     *
+     * @retval                LT_OK Method executed successfully
+     * @retval                other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t startSession(const uint8_t stPub[], const uint8_t shiPriv[], const uint8_t shiPub[],
+                          const lt_pkey_index_t pkeyIndex, HandshakeTiming *timing = nullptr);
+
+    /**
+     * @brief Returns the running aggregate of HandshakeTiming of successful secureSessionStart() and startSession()
+     * calls.
+     *
+     * @return  Aggregate since the construction or the last resetHandshakeStats()
+     */
+    const HandshakeStats &getHandshakeStats(void) const;
+
+    /**
+     * @brief Resets the aggregate returned by getHandshakeStats().
+     */
+    void resetHandshakeStats(void);
+
+    /**
+     * @brief Prepares one host ephemeral X25519 key pair for a future Secure Channel Session handshake.
+     * @details Generating the ephemeral key pair is a full X25519 scalar multiplication on the host. Calling this
+     * method in idle time (e.g. from `loop()`) moves it out of secureSessionStart() and startSession(), which take a
+     * prepared key pair if there is one, and generate it on the fly otherwise. Each prepared key pair is used for one
+     * handshake only and wiped afterwards. Up to EPH_KEYS_POOL_LEN key pairs are kept, calling this method with a full
+     * pool does nothing.
+     * @note MbedTLS's PSA Crypto must be initialized before calling this method.
+     *
+     * @retval  LT_OK  Method executed successfully
+     * @retval  other  Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t prepareSession(void);
+
+    /**
+     * @brief Returns the number of ephemeral key pairs prepared by prepareSession() and not used yet.
+     *
+     * @return  Number of prepared key pairs
+     */
+    uint8_t getPreparedSessionCount(void) const;
+
+    /**
+     * @brief Returns the cached ChipIdentity, e.g. to store it in host's non-volatile memory.
+     *
+     * @param identity[out]  Cached identity
+     *
+     * @retval               true  Identity is cached
+     * @retval               false Nothing is cached yet, `identity` was not changed
+     */
+    bool getChipIdentity(ChipIdentity &identity) const;
+
+    /**
+     * @brief Fills the ChipIdentity cache, e.g. from host's non-volatile memory on boot.
+     * @warning The identity is trusted without any verification. Only load it from storage which cannot be modified
+     * by an attacker, otherwise a forged public key could be used for the handshake.
+     *
+     * @param identity[in]  Identity obtained by getChipIdentity()
+     */
+    void setChipIdentity(const ChipIdentity &identity);
+
+    /**
+     * @brief Drops the cached ChipIdentity, so the certificate store is read again by the next secureSessionStart().
+     */
+    void clearChipIdentity(void);
+
+    /**
+     * @brief Enables or disables automatic recovery of a lost Secure Channel Session (disabled by default).
+     * @details When enabled, Tropic01 remembers the pairing keys passed to the last successful secureSessionStart()
+     * or startSession(). If a command fails because the session is no longer valid (e.g. TROPIC01 was reset or
+     * a brown-out occurred), the session is started again with these keys and the command is retried once.
+     * Remembered keys are forgotten by secureSessionEnd(), end() and by a failed start with other keys.
+     * @note Only pointers to the pairing keys are stored, so the arrays must stay valid. In-place commands are not
+     * retried, because their data were already encrypted in the L3 buffer.
+     *
+     * @param enable[in]  true to enable, false to disable
+     */
+    void setAutoRecovery(const bool enable);
+
+    /**
+     * @brief Returns statistics of the automatic session recovery.
+     *
+     * @return  Statistics since the construction or the last resetRecoveryStats()
+     */
+    const RecoveryStats &getRecoveryStats(void) const;
+
+    /**
+     * @brief Resets statistics of the automatic session recovery.
+     */
+    void resetRecoveryStats(void);
+
+    /**
+     * @brief Sets after how long without any command the Secure Channel Session is closed by sessionPoll().
+     * @details A session closed this way is opened again (with the pairing keys of the last successful
+     * secureSessionStart() or startSession()) by the next command which needs it, or ahead of time by
+     * expectActivity().
+     *
+     * @param timeoutMs[in]  Idle timeout in milliseconds, 0 disables closing idle sessions (default)
+     */
+    void setSessionIdleTimeout(const uint32_t timeoutMs);
+
+    /**
+     * @brief Closes the Secure Channel Session if it has been idle for longer than set by setSessionIdleTimeout().
+     * @note Call this method regularly, e.g. from `loop()`.
+     *
+     * @retval  LT_OK  Method executed successfully
+     * @retval  other  Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t sessionPoll(void);
+
+    /**
+     * @brief Tells Tropic01 that commands are going to follow soon.
+     * @details If the Secure Channel Session was closed by sessionPoll(), it is opened again now, so the next command
+     * does not pay for the handshake. Also restarts the idle timeout.
+     *
+     * @retval  LT_OK  Method executed successfully
+     * @retval  other  Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t expectActivity(void);
+
+    /**
+     * @brief Registers a pairing identity (pairing keys and their slot), which can be later used by useIdentity().
+     * @note Only pointers to the pairing keys are stored, so the arrays must stay valid.
+     *
+     * @param index[in]      Index of the identity (0 - MAX_IDENTITIES-1), an existing identity is replaced
+     * @param shiPriv[in]    Host's private pairing key for the slot `pkeyIndex`
+     * @param shiPub[in]     Host's public pairing key for the slot `pkeyIndex`
+     * @param pkeyIndex[in]  Pairing key index
+     *
+     * @retval               LT_OK Method executed successfully
+     * @retval               LT_PARAM_ERR Invalid index or keys
+     */
+    lt_ret_t registerIdentity(const uint8_t index, const uint8_t shiPriv[], const uint8_t shiPub[],
+                              const lt_pkey_index_t pkeyIndex);
+
+    /**
+     * @brief Switches the Secure Channel Session to a pairing identity registered by registerIdentity().
+     * @details Nothing is done when the session with this identity is already established. Otherwise, the current
+     * session is aborted and a new one is started. If the chip was already verified (see ChipIdentity), only the
+     * handshake is executed. When the switch fails, no session is open and neither auto-recovery nor the idle
+     * timeout re-open the previous identity.
+     *
+     * @param index[in]  Index of the identity
+     *
+     * @retval           LT_OK Method executed successfully
+     * @retval           other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t useIdentity(const uint8_t index);
 
     /**
      * @brief Aborts Secure Channel Session with TROPIC01.
@@ -98,6 +515,67 @@ class Tropic01 {
      */
     lt_ret_t secureSessionEnd(void);
 
+    /**
+     * @brief Scope guard of a Secure Channel Session.
+     * @details The session is started by the constructor (see secureSessionStart()) and aborted by the destructor,
+     * so every return path of the scope ends the session exactly once. Nothing is sent to TROPIC01 by the destructor
+     * when the session is not established anymore. The guard is move-only and does not allocate.
+     *
+     * @code
+     * Tropic01::Session session(tropic01, PAIRING_KEY_PRIV, PAIRING_KEY_PUB, PAIRING_KEY_SLOT);
+     * if (!session.active()) {
+     *     return session.status();
+     * }
+     * @endcode
+     */
+    class Session {
+       public:
+        /**
+         * @brief Starts the Secure Channel Session with secureSessionStart().
+         *
+         * @param chip[in]       Initialized Tropic01 instance, must outlive the guard
+         * @param shiPriv[in]    Host's private pairing key for the slot `pkeyIndex`
+         * @param shiPub[in]     Host's public pairing key for the slot `pkeyIndex`
+         * @param pkeyIndex[in]  Pairing key index
+         */
+        Session(Tropic01 &chip, const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex);
+        Session(Session &&other);
+        Session &operator=(Session &&other);
+        ~Session();
+
+        Session(const Session &) = delete;
+        Session &operator=(const Session &) = delete;
+
+        /**
+         * @brief Checks, without communicating with TROPIC01, whether the guarded session is usable.
+         * @note A session closed by the idle timeout (see setSessionIdleTimeout()) counts as active, it is re-opened
+         * by the next command.
+         *
+         * @return  true if the session is established
+         */
+        bool active(void) const;
+
+        /**
+         * @brief Returns the result of starting the session.
+         *
+         * @return  Return value of secureSessionStart() called by the constructor
+         */
+        lt_ret_t status(void) const;
+
+        /**
+         * @brief Ends the session before the end of the scope. The destructor then does nothing.
+         *
+         * @retval  LT_OK Method executed successfully
+         * @retval  other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+         * encoding of returned value
+         */
+        lt_ret_t end(void);
+
+       private:
+        Tropic01 *tropic01;
+        lt_ret_t ret;
+    };
+
     /**
      * @brief Executes the TROPIC01's Ping command. It is a dummy command to check the Secure Channel Session
      * is valid by exchanging a message with TROPIC01, which is echoed through the Secure Channel.
@@ -178,6 +656,123 @@ class Tropic01 {
      */
     lt_ret_t ecdsaSign(const lt_ecc_slot_t slot, const uint8_t msg[], const uint32_t msgLen, uint8_t rs[]);
 
+    /**
+     * @brief Performs ECDSA signature of a message and writes it in the requested format.
+     * @details The signature is encoded in place, no other buffer is needed.
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param msg[in]      Buffer containing a message to sign
+     * @param msgLen[in]   Length of the message
+     * @param sig[out]     Buffer for storing the signature (must be signatureMaxLen(format) bytes)
+     * @param sigLen[out]  Length of the signature
+     * @param format[in]   Signature format
+     *
+     * @retval             LT_OK Method executed successfully
+     * @retval             other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t ecdsaSign(const lt_ecc_slot_t slot, const uint8_t msg[], const uint32_t msgLen, uint8_t sig[],
+                       uint8_t &sigLen, const SignatureFormat format);
+
+    /**
+     * @brief Performs ECDSA signatures of several messages with one private ECC key stored in TROPIC01.
+     * @details While TROPIC01 signs one message, the host computes SHA-256 digest of the next one. Every message is
+     * signed independently, its result is stored into `rets`.
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param msgs[in]     Messages to sign
+     * @param msgLens[in]  Lengths of the messages
+     * @param count[in]    Number of the messages
+     * @param sigs[out]    Buffers for storing signature R and S bytes (each must be 64 bytes)
+     * @param rets[out]    Results of the particular signatures
+     *
+     * @retval             LT_OK All messages were signed successfully
+     * @retval             other Result of the first failed signature, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t ecdsaSignBatch(const lt_ecc_slot_t slot, const uint8_t *const msgs[], const uint32_t msgLens[],
+                            const uint16_t count, uint8_t *const sigs[], lt_ret_t rets[]);
+
+    /**
+     * @brief Performs ECDSA signature of an already computed SHA-256 digest of a message.
+     * @details The digest is sent to TROPIC01 as it is, no hashing is done on the host.
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param digest[in]   SHA-256 digest of the message (must be 32 bytes)
+     * @param rs[out]      Buffer for storing signature R and S bytes (must be 64 bytes)
+     *
+     * @retval             LT_OK Method executed successfully
+     * @retval             other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t ecdsaSignDigest(const lt_ecc_slot_t slot, const uint8_t digest[], uint8_t rs[]);
+
+    /**
+     * @brief Performs ECDSA signature of an already computed SHA-256 digest and writes it in the requested format.
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param digest[in]   SHA-256 digest of the message (must be 32 bytes)
+     * @param sig[out]     Buffer for storing the signature (must be signatureMaxLen(format) bytes)
+     * @param sigLen[out]  Length of the signature
+     * @param format[in]   Signature format
+     *
+     * @retval             LT_OK Method executed successfully
+     * @retval             other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t ecdsaSignDigest(const lt_ecc_slot_t slot, const uint8_t digest[], uint8_t sig[], uint8_t &sigLen,
+                             const SignatureFormat format);
+
+    /**
+     * @brief Starts streaming ECDSA signature of a message, which is passed in chunks by ecdsaSignUpdate().
+     * @details Only SHA-256 digest of the message is computed on the host and sent to TROPIC01 by ecdsaSignFinish(),
+     * so the message does not have to be in RAM at once. A previously started signature is discarded.
+     *
+     * @retval  LT_OK Method executed successfully
+     * @retval  LT_CRYPTO_ERR Hash operation could not be started
+     */
+    lt_ret_t ecdsaSignStart(void);
+
+    /**
+     * @brief Passes next chunk of the message started by ecdsaSignStart().
+     *
+     * @param chunk[in]     Chunk of the message
+     * @param chunkLen[in]  Length of the chunk
+     *
+     * @retval              LT_OK Method executed successfully
+     * @retval              LT_FAIL ecdsaSignStart() was not called
+     * @retval              LT_CRYPTO_ERR Hashing failed, the signature has to be started again
+     */
+    lt_ret_t ecdsaSignUpdate(const uint8_t chunk[], const uint32_t chunkLen);
+
+    /**
+     * @brief Finishes the message started by ecdsaSignStart() and performs its ECDSA signature.
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param rs[out]      Buffer for storing signature R and S bytes (must be 64 bytes)
+     *
+     * @retval             LT_OK Method executed successfully
+     * @retval             LT_FAIL ecdsaSignStart() was not called
+     * @retval             other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t ecdsaSignFinish(const lt_ecc_slot_t slot, uint8_t rs[]);
+
+    /**
+     * @brief Finishes the message started by ecdsaSignStart() and writes its signature in the requested format.
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param sig[out]     Buffer for storing the signature (must be signatureMaxLen(format) bytes)
+     * @param sigLen[out]  Length of the signature
+     * @param format[in]   Signature format
+     *
+     * @retval             LT_OK Method executed successfully
+     * @retval             LT_FAIL ecdsaSignStart() was not called
+     * @retval             other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t ecdsaSignFinish(const lt_ecc_slot_t slot, uint8_t sig[], uint8_t &sigLen, const SignatureFormat format);
+
     /**
      * @brief Performs EdDSA signature of a message with a private ECC key stored in TROPIC01.
      *
@@ -192,6 +787,26 @@ class Tropic01 {
      */
     lt_ret_t eddsaSign(const lt_ecc_slot_t slot, const uint8_t msg[], const uint16_t msgLen, uint8_t rs[]);
 
+    /**
+     * @brief Performs EdDSA signature of a message read from a source, e.g. an external flash.
+     * @details The message is read in chunks directly into the L3 buffer, so no other copy of it is kept in RAM.
+     * TROPIC01 signs the whole message in one command, so the length limit is the same as for eddsaSign().
+     *
+     * @param slot[in]      Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param source[in]    Function reading the message
+     * @param ctx[in]       Context passed to `source`
+     * @param msgLen[in]    Length of the message (max 4096 bytes)
+     * @param rs[out]       Buffer for storing signature R and S bytes (must be 64 bytes)
+     * @param chunkLen[in]  Maximal length of one part requested from `source`
+     *
+     * @retval              LT_OK Method executed successfully
+     * @retval              LT_PARAM_ERR The message is too long
+     * @retval              other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t eddsaSignSource(const lt_ecc_slot_t slot, MessageSource source, void *ctx, const uint16_t msgLen,
+                             uint8_t rs[], const uint16_t chunkLen = 256);
+
     /**
      * @brief Writes bytes into a given slot of the User Partition in the R memory.
      *
@@ -248,11 +863,282 @@ class Tropic01 {
      */
     lt_ret_t macAndDestroy(const lt_mac_and_destroy_slot_t slot, const uint8_t dataOut[], uint8_t dataIn[]);
 
+    /**
+     * @name In-place (zero-copy) commands
+     * @brief Variants of the commands above, which work directly with the L3 buffer instead of caller's buffers.
+     * @details First, get a writable view into the command payload area of the L3 buffer via the `...Buffer()`
+     * method and write the command data into it. Then, call the matching `...InPlace()` method, which encrypts the
+     * data in place and sends it to TROPIC01. Response data are returned as a read-only view into the decrypted L3
+     * buffer.
+     * @warning All views are valid only until the next call of any method of this instance (or of any other instance
+     * sharing the same L3 buffer when LT_SEPARATE_L3_BUFF=1).
+     * @{
+     */
+
+    /**
+     * @brief Returns a writable view for the Ping message going out.
+     *
+     * @param maxLen[out]  Maximal length of the message
+     *
+     * @return             Pointer into the L3 buffer
+     */
+    uint8_t *pingBuffer(uint16_t &maxLen);
+
+    /**
+     * @brief Executes the TROPIC01's Ping command with the message written into pingBuffer().
+     *
+     * @param msgLen[in]  Length of the message
+     * @param msgIn[out]  View of the Ping message going in (`msgLen` bytes)
+     *
+     * @retval            LT_OK Method executed successfully
+     * @retval            other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t pingInPlace(const uint16_t msgLen, const uint8_t *&msgIn);
+
+    /**
+     * @brief Returns a writable view for data to be written into R memory.
+     *
+     * @param maxLen[out]  Maximal size of the data (actual maximum depends on TROPIC01 Application FW, see rMemWrite())
+     *
+     * @return             Pointer into the L3 buffer
+     */
+    uint8_t *rMemWriteBuffer(uint16_t &maxLen);
+
+    /**
+     * @brief Writes data from rMemWriteBuffer() into a given slot of the User Partition in the R memory.
+     *
+     * @param udataSlot[in]  Memory slot to be written (0 - TR01_R_MEM_DATA_SLOT_MAX)
+     * @param dataSize[in]   Size of data to be written into slot
+     *
+     * @retval               LT_OK Method executed successfully
+     * @retval               other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t rMemWriteInPlace(const uint16_t udataSlot, const uint16_t dataSize);
+
+    /**
+     * @brief Reads bytes from a given slot of the User Partition in the R memory without copying them.
+     *
+     * @param udataSlot[in]      Memory slot to be read (0 - TR01_R_MEM_DATA_SLOT_MAX)
+     * @param data[out]          View of the read data
+     * @param dataReadSize[out]  Number of bytes read from TROPIC01 slot
+     *
+     * @retval                   LT_OK Method executed successfully
+     * @retval                   other Method did not execute successfully, you might use lt_ret_verbose() to get
+     * verbose encoding of returned value
+     */
+    lt_ret_t rMemReadInPlace(const uint16_t udataSlot, const uint8_t *&data, uint16_t &dataReadSize);
+
+    /**
+     * @brief Returns a writable view for a message to be signed by eddsaSignInPlace().
+     *
+     * @param maxLen[out]  Maximal length of the message
+     *
+     * @return             Pointer into the L3 buffer
+     */
+    uint8_t *eddsaSignBuffer(uint16_t &maxLen);
+
+    /**
+     * @brief Performs EdDSA signature of the message written into eddsaSignBuffer().
+     *
+     * @param slot[in]     Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31)
+     * @param msgLen[in]   Length of the message
+     * @param rs[out]      Buffer for storing signature R and S bytes (must be 64 bytes)
+     *
+     * @retval             LT_OK Method executed successfully
+     * @retval             other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t eddsaSignInPlace(const lt_ecc_slot_t slot, const uint16_t msgLen, uint8_t rs[]);
+
+    /**
+     * @brief Returns a writable view for the data sent by macAndDestroyInPlace() (32 bytes).
+     *
+     * @return  Pointer into the L3 buffer
+     */
+    uint8_t *macAndDestroyBuffer(void);
+
+    /**
+     * @brief Executes the MAC-and-Destroy sequence with data written into macAndDestroyBuffer().
+     *
+     * @param slot[in]      MAC-and-Destroy slot index (TR01_MAC_AND_DESTROY_SLOT_0 - TR01_MAC_AND_DESTROY_SLOT_127)
+     * @param dataIn[out]   View of the data returned from TROPIC01 (32 bytes)
+     *
+     * @retval              LT_OK Method executed successfully
+     * @retval              other Method did not execute successfully, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t macAndDestroyInPlace(const lt_mac_and_destroy_slot_t slot, const uint8_t *&dataIn);
+
+    /** @} */
+
    private:
+    friend class Tropic01Bus;
+
+    template <typename F>
+    lt_ret_t runCommand(const CommandType type, F command);
+    template <typename F>
+    lt_ret_t runSessionCommand(const CommandType type, F command);
+    template <typename F>
+    lt_ret_t pollResponse(F receive);
+    struct HandshakeSums {
+        uint64_t chipIdUs;
+        uint64_t certStoreUs;
+        uint64_t stPubParseUs;
+        uint64_t ephKeysUs;
+        uint64_t handshakeUs;
+        uint64_t hostKeysUs;
+        uint64_t totalUs;
+    };
+    struct PairingIdentity {
+        const uint8_t *shiPriv;
+        const uint8_t *shiPub;
+        lt_pkey_index_t pkeyIndex;
+    };
+
+    void rememberSessionKeys(const uint8_t shiPriv[], const uint8_t shiPub[], const lt_pkey_index_t pkeyIndex);
+    void forgetSessionKeys(void);
+    void updateSessionKeys(const lt_ret_t startRet, const uint8_t shiPriv[], const uint8_t shiPub[],
+                           const lt_pkey_index_t pkeyIndex);
+    lt_ret_t reopenIdleSession(void);
+    lt_ret_t handshake(const uint8_t stPub[], const uint8_t shiPriv[], const uint8_t shiPub[],
+                       const lt_pkey_index_t pkeyIndex);
+    void wipeEphKeysPool(void);
+    void finishHandshakeTiming(const uint32_t startUs, const lt_ret_t ret, HandshakeTiming *timing);
+
+    void traceRecord(const TraceKind kind, const uint16_t len, const uint8_t status);
+
+    uint16_t l3BuffLen(void) const;
+    uint16_t l3CmdPayloadMaxLen(void) const;
+    uint8_t *l3CmdPayload(void);
+    lt_ret_t l3Send(const uint8_t cmdId, const uint16_t payloadLen);
+    lt_ret_t l3Receive(const uint8_t *&resPayload, uint16_t &resPayloadLen);
+    lt_ret_t signSend(const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve, const uint8_t msg[],
+                      const uint32_t msgLen);
+    lt_ret_t signSendPayload(const uint8_t cmdId, const lt_ecc_slot_t slot, const uint16_t msgFieldLen);
+    lt_ret_t signReceive(uint8_t rs[]);
+    lt_ret_t readStPub(uint8_t stPub[]);
+    lt_ret_t verifyChipId(const struct lt_chip_id_t &chipId);
+    lt_ret_t checkSpiRoundTrips(const struct lt_chip_id_t &referenceChipId, const uint16_t rounds);
+
     lt_dev_arduino_t device;
     lt_ctx_mbedtls_v4_t cryptoCtx;
     lt_handle_t handle;
     bool initialized;
+    uint32_t spiClockHz;
+    BusyRetryPolicy busyRetryPolicy;
+    TraceEntry *traceBuffer;
+    uint16_t traceBufferLen;
+    uint16_t traceHead;
+    uint16_t traceCount;
+    ChipIdentity chipIdentity;
+    bool chipIdentityValid;
+    bool autoRecovery;
+    RecoveryStats recoveryStats;
+    const uint8_t *sessionShiPriv;
+    const uint8_t *sessionShiPub;
+    lt_pkey_index_t sessionPkeyIndex;
+    uint32_t sessionIdleTimeoutMs;
+    uint32_t sessionLastActivityMs;
+    bool sessionIdleClosed;
+    PairingIdentity identities[MAX_IDENTITIES];
+    lt_host_eph_keys_t ephKeysPool[EPH_KEYS_POOL_LEN];
+    uint8_t ephKeysCount;
+    HandshakeTiming handshakeTiming;
+    HandshakeStats handshakeStats;
+    HandshakeSums handshakeSums;
+    psa_hash_operation_t signHashOp;
+    bool signHashActive;
+};
+
+/**
+ * @brief One signing operation executed by Tropic01Bus::sign().
+ *
+ */
+struct Tropic01SignJob {
+    Tropic01 *chip;             /**< Registered TROPIC01 instance which signs the message */
+    lt_ecc_slot_t slot;         /**< Slot containing a private key (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31) */
+    lt_ecc_curve_type_t curve;  /**< TR01_CURVE_P256 for ECDSA, TR01_CURVE_ED25519 for EdDSA */
+    const uint8_t *msg;         /**< Message to sign (max length 4096 bytes for EdDSA) */
+    uint32_t msgLen;            /**< Length of the message */
+    uint8_t *rs;                /**< Buffer for storing signature R and S bytes (must be 64 bytes) */
+    lt_ret_t ret;               /**< Result of the job, filled by Tropic01Bus::sign() */
+};
+
+/**
+ * @brief Arbitrates several TROPIC01 chips sharing one SPI bus.
+ * @details Instead of waiting for one chip to finish its command before talking to the next one, all L3 requests are
+ * sent first and the responses are collected afterwards. While one chip computes, the bus is used to talk to the
+ * others.
+ * @note Each registered Tropic01 instance must have its own Secure Channel Session. Jobs for instances sharing one
+ * L3 buffer (LT_SEPARATE_L3_BUFF=1) cannot overlap and are executed one after another.
+ * @note The sending and the receiving of a job are traced as two separate commands. The automatic session recovery
+ * (see Tropic01::setAutoRecovery()) applies only to the sending, a request which reached TROPIC01 is never repeated.
+ *
+ */
+class Tropic01Bus {
+   public:
+    /** @brief Maximal number of registered Tropic01 instances. */
+    static const uint8_t MAX_CHIPS = 4;
+
+    Tropic01Bus();
+
+    Tropic01Bus(const Tropic01Bus &) = delete;
+    Tropic01Bus &operator=(const Tropic01Bus &) = delete;
+    Tropic01Bus(Tropic01Bus &&) = delete;
+    Tropic01Bus &operator=(Tropic01Bus &&) = delete;
+
+    /**
+     * @brief Registers a Tropic01 instance with the arbiter.
+     *
+     * @param chip[in]  Tropic01 instance using the same `SPIClass` as the already registered instances
+     *
+     * @retval          LT_OK Method executed successfully
+     * @retval          LT_PARAM_ERR Too many instances, or a different `SPIClass` is used
+     */
+    lt_ret_t add(Tropic01 &chip);
+
+    /**
+     * @brief Executes signing jobs, overlapping the computation of different chips.
+     * @details Jobs are processed in order. Consecutive jobs for different chips are sent first and their responses
+     * are read afterwards. The result of each job is stored in its `ret` member.
+     *
+     * @param jobs[in,out]  Signing jobs, each referring to a registered Tropic01 instance
+     * @param jobsCount[in] Number of jobs
+     *
+     * @retval              LT_OK All jobs executed successfully
+     * @retval              other Result of the first failed job, you might use lt_ret_verbose() to get verbose
+     * encoding of returned value
+     */
+    lt_ret_t sign(Tropic01SignJob jobs[], const uint16_t jobsCount);
+
+    /**
+     * @brief Returns the number of successful signatures across all chips since the last resetStats().
+     *
+     * @return  Number of signatures
+     */
+    uint32_t getSignatureCount(void) const;
+
+    /**
+     * @brief Returns the total throughput across all chips since the last resetStats().
+     *
+     * @return  Signatures per second
+     */
+    uint32_t getThroughput(void) const;
+
+    /**
+     * @brief Resets the statistics returned by getSignatureCount() and getThroughput().
+     */
+    void resetStats(void);
+
+   private:
+    bool isRegistered(const Tropic01 *chip) const;
+
+    Tropic01 *chips[MAX_CHIPS];
+    uint8_t chipsCount;
+    uint32_t signatureCount;
+    uint64_t elapsedUs;
 };
 
 #endif  // LIBTROPIC_ARDUINO_H
\ No newline at end of file